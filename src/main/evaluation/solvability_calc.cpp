@@ -27,6 +27,7 @@
 
 #include "solvability_calc.h"
 #include "../solver/solver.h"
+#include "../solver/portfolio_solver.h"
 #include "binomial_ci.h"
 
 using namespace std;
@@ -84,8 +85,19 @@ void solvability_calc::print_seeds_in_prog(std::set<int>& seeds_in_progress) {
 // SOLVING METHODS //
 /////////////////////
 
+// Counts the effort of a search which ran first in the result of the one
+// after it
+static void add_effort(solver::result& res, const solver::result& first) {
+    res.states_searched += first.states_searched;
+    res.unique_states_searched += first.unique_states_searched;
+    res.time += first.time;
+}
+
 void solvability_calc::calculate_solvability_percentage(uint64_t timeout_, int seed_count_, uint cores,
-                                                        cmd_sos stream_opt_, const vector<int>& resume) {
+                                                        cmd_sos stream_opt_, const vector<int>& resume,
+                                                        uint64_t restarts_, command_line_helper::search_type search_,
+                                                        solver::search_limits limits_, uint nrpa_level_,
+                                                        uint nrpa_iterations_) {
     resume_seeds = vector<int>(begin(resume) + 3, end(resume));
     sort(begin(resume_seeds), end(resume_seeds));
 
@@ -100,6 +112,11 @@ void solvability_calc::calculate_solvability_percentage(uint64_t timeout_, int s
     solver::print_header(timeout.count(), stream_opt_);
     seed_count = seed_count_;
     stream_opt = stream_opt_;
+    restarts = restarts_;
+    search = search_;
+    limits = limits_;
+    nrpa_level = nrpa_level_;
+    nrpa_iterations = nrpa_iterations_;
 
     vector<std::thread> threads(cores);
 
@@ -120,22 +137,50 @@ void solvability_calc::solver_thread(solvability_calc* sc, uint core) {
 
         optional<seed_result> stream_res, no_stream_res, final_res;
 
-        if (sc->stream_opt == cmd_sos::SMART) {
-            stream_res = solve_seed(my_seed, (sc->timeout/10), sc->rules, sc->cache_capacity, sos::BOTH);
+        // The limited search is a quick pre-pass on the deal without
+        // streamliners, run once for the seed with 10% of the timeout. Only
+        // the deals it can't decide are searched in full, in the time left
+        optional<solver::result> pre_pass;
+        if (sc->limits.limited()) {
+            pre_pass = pre_pass_seed(my_seed, sc->timeout / 10, sc->rules, sc->cache_capacity, sc->limits);
+        }
+        const millisec timeout = pre_pass ? sc->timeout - pre_pass->time : sc->timeout;
+
+        // Unsolvable is only reported when no moves were left out
+        if (pre_pass && (pre_pass->sol_type == solver::result::type::SOLVED
+                         || pre_pass->sol_type == solver::result::type::UNSOLVABLE)) {
+            no_stream_res = seed_result(my_seed, *pre_pass);
+            final_res = *no_stream_res;
+        } else if (sc->stream_opt == cmd_sos::SMART) {
+            stream_res = solve_seed(my_seed, (sc->timeout/10), sc->rules, sc->cache_capacity, sos::BOTH,
+                                    sc->restarts, sc->search, sc->nrpa_level, sc->nrpa_iterations);
 
             switch (stream_res->second.sol_type) {
                 case solver::result::type::UNSOLVABLE:
                 case solver::result::type::TIMEOUT:
-                    no_stream_res = solve_seed(my_seed, sc->timeout, sc->rules, sc->cache_capacity, sos::NONE);
+                    no_stream_res = solve_seed(my_seed, timeout, sc->rules, sc->cache_capacity, sos::NONE,
+                                               sc->restarts, sc->search, sc->nrpa_level, sc->nrpa_iterations);
+                    if (pre_pass) add_effort(no_stream_res->second, *pre_pass);
                     final_res = *no_stream_res;
                     break;
                 default:
+                    if (pre_pass) add_effort(stream_res->second, *pre_pass);
                     final_res = *stream_res;
                     break;
             }
+        } else if (sc->stream_opt == cmd_sos::PORTFOLIO) {
+            portfolio_solver ps(sc->rules, my_seed, boost::none, sc->cache_capacity);
+            ps.run(sc->timeout);
+
+            stream_res = seed_result(my_seed, ps.get_streamliner_result());
+            optional<solver::result> non_stream_sol = ps.get_non_streamliner_result();
+            if (non_stream_sol) no_stream_res = seed_result(my_seed, *non_stream_sol);
+            final_res = no_stream_res ? *no_stream_res : *stream_res;
         } else {
-            no_stream_res = solve_seed(my_seed, sc->timeout, sc->rules, sc->cache_capacity,
-                                       command_line_helper::convert_streamliners(sc->stream_opt));
+            no_stream_res = solve_seed(my_seed, timeout, sc->rules, sc->cache_capacity,
+                                       command_line_helper::convert_streamliners(sc->stream_opt), sc->restarts,
+                                       sc->search, sc->nrpa_level, sc->nrpa_iterations);
+            if (pre_pass) add_effort(no_stream_res->second, *pre_pass);
             final_res = *no_stream_res;
         }
 
@@ -146,8 +191,10 @@ void solvability_calc::solver_thread(solvability_calc* sc, uint core) {
 
         cout << my_seed;
         //print_general_info(sc->seed_res);
-        if (sc->stream_opt == cmd_sos::SMART) {
-            print_seed_info(*stream_res);
+        if (sc->stream_opt == cmd_sos::SMART || sc->stream_opt == cmd_sos::PORTFOLIO) {
+            // A seed decided by the pre-pass has no streamlined result
+            if (stream_res) print_seed_info(*stream_res);
+            else solver::print_null_seed_info();
             if (no_stream_res) {
                 print_seed_info(*no_stream_res);
                 cout << ", " << no_stream_res->second.sol_type;
@@ -168,12 +215,43 @@ void solvability_calc::solver_thread(solvability_calc* sc, uint core) {
     }
 }
 
+solver::result solvability_calc::pre_pass_seed(int seed, millisec timeout, const sol_rules& rules,
+                                               uint64_t cache_capacity, solver::search_limits limits) {
+    solver limited_sol(game_state(rules, seed, sos::NONE), cache_capacity);
+    limited_sol.set_search_limits(limits);
+    return limited_sol.run(timeout);
+}
+
 solvability_calc::seed_result solvability_calc::solve_seed(int seed, millisec timeout, const sol_rules& rules,
                                                           uint64_t cache_capacity,
-                                                          game_state::streamliner_options stream_opt) {
-    game_state gs(rules, seed, stream_opt);
+                                                          game_state::streamliner_options stream_opt,
+                                                          uint64_t restarts,
+                                                          command_line_helper::search_type search,
+                                                          uint nrpa_level, uint nrpa_iterations) {
+    return solve_seed(seed, timeout, game_state(rules, seed, stream_opt), cache_capacity, restarts, search,
+                      nrpa_level, nrpa_iterations);
+}
+
+solvability_calc::seed_result solvability_calc::solve_seed(int seed, millisec timeout, const game_state& gs,
+                                                          uint64_t cache_capacity, uint64_t restarts,
+                                                          command_line_helper::search_type search,
+                                                          uint nrpa_level, uint nrpa_iterations) {
     solver sol(gs, cache_capacity);
 
+    if (search == command_line_helper::search_type::DFPN) return seed_result(seed, sol.run_DFPN(timeout));
+    if (search == command_line_helper::search_type::BEST_FIRST) return seed_result(seed, sol.run_best_first(timeout));
+    if (search == command_line_helper::search_type::NRPA) {
+        // Rollouts can only find a solution, so once their iterations are
+        // spent, the rest of the timeout goes to a DFS
+        solver::result rollouts = sol.run_NRPA(nrpa_level, nrpa_iterations, timeout);
+        if (rollouts.sol_type != solver::result::type::INCONCLUSIVE) return seed_result(seed, rollouts);
+
+        seed_result full = solve_seed(seed, timeout - rollouts.time, gs, cache_capacity, restarts,
+                                      command_line_helper::search_type::DFS, nrpa_level, nrpa_iterations);
+        add_effort(full.second, rollouts);
+        return full;
+    }
+    if (restarts > 0) return seed_result(seed, sol.run_restarts(restarts, 0, timeout));
     return seed_result(seed, sol.run(optional<std::chrono::milliseconds>(timeout)));
 }
 
@@ -201,5 +279,9 @@ void solvability_calc::seed_results::add_result(solver::result::type t) {
             break;
         case solver::result::type ::TERMINATED:
             break;
+        // Only a limited search is inconclusive, and a full search follows it
+        case solver::result::type::INCONCLUSIVE:
+            timed_out++;
+            break;
     }
 }
@@ -37,7 +37,12 @@ class solvability_calc {
 public:
     explicit solvability_calc(const sol_rules&, uint64_t);
 
-    void calculate_solvability_percentage(uint64_t, int, uint, command_line_helper::streamliner_opt, const std::vector<int>&);
+    // Searches with restarts after the supplied number of states, unless it is 0.
+    // If the search limits limit the search, a search with them is run first.
+    // The last two are the nesting level and iterations of 'nrpa' search
+    void calculate_solvability_percentage(uint64_t, int, uint, command_line_helper::streamliner_opt,
+                                          const std::vector<int>&, uint64_t, command_line_helper::search_type,
+                                          solver::search_limits, uint, uint);
 
 private:
     typedef std::pair<int, solver::result> seed_result;
@@ -59,7 +64,12 @@ private:
 
     // Solving methods
     static void solver_thread(solvability_calc*, uint core);
-    static seed_result solve_seed(int, std::chrono::milliseconds, const sol_rules&, uint64_t, game_state::streamliner_options);
+    static solver::result pre_pass_seed(int, std::chrono::milliseconds, const sol_rules&, uint64_t,
+                                        solver::search_limits);
+    static seed_result solve_seed(int, std::chrono::milliseconds, const sol_rules&, uint64_t, game_state::streamliner_options,
+                                  uint64_t, command_line_helper::search_type, uint, uint);
+    static seed_result solve_seed(int, std::chrono::milliseconds, const game_state&, uint64_t, uint64_t,
+                                  command_line_helper::search_type, uint, uint);
 
     const sol_rules& rules;
     const uint64_t cache_capacity;
@@ -71,6 +81,11 @@ private:
     std::atomic<int> current_seed;
     int seed_count;
     command_line_helper::streamliner_opt stream_opt;
+    uint64_t restarts;
+    command_line_helper::search_type search;
+    solver::search_limits limits;
+    uint nrpa_level;
+    uint nrpa_iterations;
 };
 
 
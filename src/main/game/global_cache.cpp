@@ -3,273 +3,429 @@
 //
 
 #include <algorithm>
-
-#include <boost/functional/hash.hpp>
+#include <cstring>
 
 #include "global_cache.h"
 #include "../input-output/output/log_helper.h"
 #include "search-state/game_state.h"
 
 using namespace std;
-using namespace boost;
 
-typedef sol_rules::build_policy pol;
 typedef sol_rules::stock_deal_type sdt;
-typedef game_state::streamliner_options sos;
 
-typedef boost::multi_index::multi_index_container<
-        cached_game_state,
-        boost::multi_index::indexed_by<
-                boost::multi_index::sequenced<>,
-                boost::multi_index::hashed_unique<
-                        boost::multi_index::identity<cached_game_state>,
-                        hasher
-                >
-        >
-> item_list;
+////////////////
+// KEY PACKER //
+////////////////
+
+// Each item is a 6 bit value. One marks a switch between face-up and
+// face-down cards (face-down cards only occur at the bottom of piles, so this
+// costs at most two items per pile), and two is a divider. Cards are stored as
+// 4 * rank + suit, so never collide with either. Zero is left for the unused
+// bits at the end of the key, so keys of different lengths never compare equal
+const uint8_t key_packer::item_bits = 6;
+static const uint8_t face_down_switch = 1;
+static const uint8_t divider = 2;
+
+struct key_packer::writer {
+    explicit writer(key_packer::word* d) : data(d), bit(0), face_down(false) {}
+
+    void add(uint8_t item) {
+        auto w = static_cast<key_packer::word>(item);
+        uint16_t idx = bit / 64;
+        uint8_t offset = bit % 64;
+
+        data[idx] |= w << offset;
+        if (offset + item_bits > 64) {
+            data[idx + 1] |= w >> (64 - offset);
+        }
+        bit += item_bits;
+    }
+
+    key_packer::word* data;
+    uint16_t bit;
+    bool face_down;
+};
+
+key_packer::key_packer(const game_state& gs) {
+    const sol_rules& rules = gs.rules;
+
+    // The suits of the cards are reduced in the same way as in the hash of
+    // the state
+    suit_mask = gs.suit_mask;
+
+    // The largest state for the rules has every card of the deck in it, a
+    // divider for each part of the state, and face-down switches at the top
+    // and bottom of each pile
+    uint16_t pile_count = uint16_t(rules.tableau_pile_count) + rules.cells
+            + rules.reserve_size + rules.sequence_count + 2;
+
+    uint32_t items = uint32_t(rules.max_rank) * 4 * (rules.two_decks ? 2 : 1);
+    items += rules.cells > 0 ? 1 : 0;
+    items += rules.stock_size > 0 ? 2 : 0;
+    items += rules.reserve_size > 0 ? 1 : 0;
+    items += rules.tableau_pile_count;
+    items += rules.sequence_count;
+    if (rules.face_up == sol_rules::face_up_policy::TOP_CARDS) {
+        items += 2 * pile_count;
+    }
 
+    uint32_t key_bits = items * item_bits;
+    uint32_t w = (key_bits + 63) / 64;
+    if (w > UINT8_MAX) {
+        throw runtime_error("Rules are too large for a cache key");
+    }
+    words = static_cast<uint8_t>(w);
+}
 
-///////////////////////
-// CACHED GAME STATE //
-///////////////////////
+uint8_t key_packer::key_words() const {
+    return words;
+}
 
-cached_game_state::cached_game_state(const game_state& gs) : live(true) {
-    data.reserve(52+18);  // Enough for each card and up to 18 piles
+void key_packer::pack(const game_state& gs, key_packer::word* data) const {
+    fill(data, data + words, 0);
+    writer wr(data);
 
     if (gs.rules.hole) {
-        add_card(gs.piles[gs.hole].top_card(), gs);
+        add_card(wr, gs.piles[gs.hole].top_card());
     }
 
     for (pile::ref pr : gs.cells) {
-        add_pile(pr, gs);
+        add_pile(wr, pr, gs);
     }
     if (gs.rules.cells > 0) {
-        add_card_divider();
+        add_card_divider(wr);
     }
 
     if (gs.rules.stock_size > 0) {
-        add_pile(gs.stock, gs);
+        add_pile(wr, gs.stock, gs);
 
         if (gs.rules.stock_deal_t == sdt::WASTE) {
             bool waste_deal_symmetry = gs.rules.stock_redeal
                     && gs.piles[gs.waste].size() % gs.rules.stock_deal_count == 0;
 
             if (waste_deal_symmetry) {
-                add_pile_in_reverse(gs.waste, gs);
+                add_pile_in_reverse(wr, gs.waste, gs);
             } else {
-                add_card_divider();
-                add_pile_in_reverse(gs.waste, gs);
+                add_card_divider(wr);
+                add_pile_in_reverse(wr, gs.waste, gs);
             }
         }
-        
-        add_card_divider();
+
+        add_card_divider(wr);
     }
 
     for (pile::ref pr : gs.reserve) {
-        add_pile(pr, gs);
-        }
+        add_pile(wr, pr, gs);
+    }
     if (gs.rules.reserve_size > 0) {
-        add_card_divider();
+        add_card_divider(wr);
     }
 
     for (pile::ref pr : gs.tableau_piles) {
-        add_pile(pr, gs);
-        add_card_divider();
+        add_pile(wr, pr, gs);
+        add_card_divider(wr);
     }
 
     for (pile::ref pr : gs.sequences) {
-        add_pile(pr, gs);
-        add_card_divider();
+        add_pile(wr, pr, gs);
+        add_card_divider(wr);
     }
 
     for (pile::ref pr : gs.accordion) {
-        add_card(gs.piles[pr].top_card(), gs);
+        add_card(wr, gs.piles[pr].top_card());
     }
+
+    assert(wr.bit <= words * 64);
 }
 
+void key_packer::add_pile(writer& wr, pile::ref pr, const game_state& gs) const {
+    for (card c : gs.piles[pr]) {
+        add_card(wr, c);
+    }
+}
 
-void cached_game_state::add_pile(pile::ref pr, const game_state& gs) {
-    for (card c : gs.piles[pr].pile_vec) {
-        add_card(c, gs);
+void key_packer::add_pile_in_reverse(writer& wr, pile::ref pr, const game_state& gs) const {
+    const pile& p = gs.piles[pr];
+    for (pile::size_type i = 0; i < p.size(); i++) {
+        add_card(wr, p[i]);
     }
 }
 
-void cached_game_state::add_pile_in_reverse(pile::ref pr, const game_state& gs) {
-    for (auto i = gs.piles[pr].pile_vec.size(); i-->0;) {
-        card c = gs.piles[pr].pile_vec[i];
-        add_card(c, gs);
+void key_packer::add_card(writer& wr, card c) const {
+    if (c.is_face_down() != wr.face_down) {
+        wr.add(face_down_switch);
+        wr.face_down = c.is_face_down();
     }
+    wr.add(static_cast<uint8_t>(c.get_rank() * 4 + (c.get_suit() & suit_mask)));
+}
+
+void key_packer::add_card_divider(writer& wr) const {
+    wr.add(divider);
+}
+
+
+///////////////
+// LRU CACHE //
+///////////////
+
+const lru_cache::handle lru_cache::empty = UINT32_MAX;
+const uint8_t lru_cache::live = 1;       // Is a parent in the current search tree
+const uint8_t lru_cache::referenced = 2; // Has been seen since the clock hand last passed
+
+// The table is kept at most 70% full. It starts small and doubles as needed up
+// to the size needed for the capacity, at which point entries are evicted
+static const lru_cache::size_type initial_slots = 1024;
+
+static const uint8_t key_block_bits = 14;
+
+static bool over_load_factor(lru_cache::size_type items, lru_cache::size_type slots) {
+    return items * 10 > slots * 7;
 }
 
-void cached_game_state::add_card(card c, const game_state& gs) {
-    auto& target = data;
+lru_cache::lru_cache(const game_state& gs, uint64_t max_num_items_)
+        : max_num_items(min(max_num_items_, uint64_t(empty) - 1))
+        , max_slots(initial_slots)
+        , packer(gs)
+        , scratch(packer.key_words())
+        , proofs_enabled(false)
+        , clock_hand(0)
+        , states_removed_from_cache(0) {
+    while (over_load_factor(max_num_items, max_slots)) max_slots *= 2;
+
+    slots.assign(min(initial_slots, max_slots), slot{empty, 0});
+    slot_mask = slots.size() - 1;
+}
 
-    // If the game is a 'hole-based' game, or suit-reduction is on, reduces
-    // the cached suit of the card where possible
+pair<lru_cache::handle, bool> lru_cache::insert(const game_state& gs) {
+    packer.pack(gs, scratch.data());
+    uint64_t hash = gs.get_hash();
 
-    bool is_suit_symmetry = (gs.rules.foundations_present
-            && (gs.stream_opts == sos::SUIT_SYMMETRY || gs.stream_opts == sos::BOTH))
-            || gs.rules.hole;
+    size_type pos = find_slot(scratch.data(), hash);
+    if (slots[pos].entry != empty) {
+        flags[slots[pos].entry] |= referenced;
+        return make_pair(slots[pos].entry, false);
+    }
 
-    if (is_suit_symmetry) {
-        switch (gs.rules.build_pol) {
-            case pol::SAME_SUIT:
-                target.emplace_back(c);
-                break;
-            case pol::RED_BLACK:
-                target.emplace_back(card(c.get_colour(), c.get_rank(), c.is_face_down()));
-                break;
-            default:
-                target.emplace_back(card(0, c.get_rank(), c.is_face_down()));
-                break;
+    handle entry;
+    if (hash_lows.size() < max_num_items) {
+        if (over_load_factor(hash_lows.size() + 1, slots.size())) {
+            assert(slots.size() < max_slots);
+            grow();
+            pos = find_slot(scratch.data(), hash);
+        }
+        entry = static_cast<handle>(hash_lows.size());
+        if ((entry >> key_block_bits) == key_blocks.size()) {
+            key_blocks.emplace_back(packer.key_words() << key_block_bits);
         }
+        hash_lows.emplace_back();
+        flags.emplace_back();
+        searched_depths.emplace_back();
+        if (proofs_enabled) proofs.emplace_back();
     } else {
-        target.emplace_back(c);
+        // The victim's slot is removed, which may move other slots along
+        entry = evict();
+        pos = find_slot(scratch.data(), hash);
+        states_removed_from_cache++;
     }
-}
 
-void cached_game_state::add_card_divider() {
-    data.emplace_back(card::divider);
+    copy(scratch.begin(), scratch.end(), key(entry));
+    hash_lows[entry] = static_cast<uint32_t>(hash);
+    flags[entry] = live | referenced;
+    searched_depths[entry] = 0;
+    if (proofs_enabled) proofs[entry] = proof_numbers{0, 0};
+    slots[pos] = slot{entry, static_cast<uint32_t>(hash >> 32)};
+
+    return make_pair(entry, true);
 }
 
-bool operator==(const cached_game_state& a, const cached_game_state& b) {
-    return a.data == b.data;
+pair<lru_cache::handle, bool> lru_cache::insert(const game_state& gs, uint32_t depth_left) {
+    pair<handle, bool> res = insert(gs);
+    handle entry = res.first;
+
+    if (res.second) {
+        searched_depths[entry] = depth_left;
+    } else if (!(flags[entry] & live) && searched_depths[entry] < depth_left) {
+        // Was searched without a solution, but not as deep as it can be now
+        searched_depths[entry] = depth_left;
+        flags[entry] |= live;
+        res.second = true;
+    }
+    return res;
 }
 
+bool lru_cache::contains(const game_state& gs) const {
+    packer.pack(gs, scratch.data());
+    uint64_t hash = gs.get_hash();
+    return slots[find_slot(scratch.data(), hash)].entry != empty;
+}
 
+bool lru_cache::covers(const game_state& gs, uint32_t depth_left) {
+    boost::optional<handle> entry = find(gs);
+    return entry && ((flags[*entry] & live) || searched_depths[*entry] >= depth_left);
+}
 
-//////////////////
-// STATE HASHER //
-//////////////////
+boost::optional<lru_cache::handle> lru_cache::find(const game_state& gs) {
+    packer.pack(gs, scratch.data());
+    uint64_t hash = gs.get_hash();
 
-hasher::hasher(const game_state& gs) : init_gs(gs) {
+    handle entry = slots[find_slot(scratch.data(), hash)].entry;
+    if (entry == empty) return boost::none;
+    flags[entry] |= referenced;
+    return entry;
 }
 
-size_t hasher::operator()(const cached_game_state& cgs) const {
-    size_t seed = 0;
+bool lru_cache::may_contain(uint64_t hash) const {
+    auto hash_high = static_cast<uint32_t>(hash >> 32);
+    auto hash_low = static_cast<uint32_t>(hash);
 
-    for (card d : cgs.data) {
-        combine(seed, hash_value(d));
+    for (size_type pos = home_slot(hash);; pos = (pos + 1) & slot_mask) {
+        const slot& s = slots[pos];
+        if (s.entry == empty) return false;
+        if (s.hash_high == hash_high && hash_lows[s.entry] == hash_low) return true;
     }
-    return seed;
 }
 
-std::size_t hasher::combine(std::size_t& seed, std::size_t value) const {
-    return seed ^= value + 0x9e3779b9 + (seed<<6) + (seed>>2);
+void lru_cache::clear() {
+    key_blocks.clear();
+    hash_lows.clear();
+    flags.clear();
+    searched_depths.clear();
+    proofs.clear();
+    clock_hand = 0;
+    fill(begin(slots), end(slots), slot{empty, 0});
+    states_removed_from_cache = 0;
 }
 
-size_t hasher::hash_value(card const& c) const {
-    boost::hash<uint8_t> boost_hasher;
-
-    // If the game is a 'hole-based' game, or suit-reduction is enabled, hash
-    // the reduced suit
-    bool is_suit_symmetry = (init_gs.rules.foundations_present
-                             && (init_gs.stream_opts == sos::SUIT_SYMMETRY || init_gs.stream_opts == sos::BOTH))
-                            || init_gs.rules.hole;
-
-    uint8_t suit_val;
-    if (is_suit_symmetry) {
-        switch (init_gs.rules.build_pol) {
-            case pol::SAME_SUIT:
-                suit_val = c.get_suit();
-                break;
-            case pol::RED_BLACK:
-                suit_val = c.get_colour();
-                break;
-            default:
-                suit_val = 0;
-        }
-    } else {
-        suit_val = c.get_suit();
-    }
+lru_cache::size_type lru_cache::size() const {
+    return hash_lows.size();
+}
 
-    auto raw_val = static_cast<uint8_t>(suit_val * 26 + 2*c.get_rank() + c.is_face_down());
-    return boost_hasher(raw_val);
+lru_cache::size_type lru_cache::bucket_count() const {
+    return slots.size();
 }
 
+void lru_cache::set_non_live(handle entry) {
+    assert(flags[entry] & live);
+    flags[entry] &= ~live;
+}
 
-///////////////
-// LRU CACHE //
-///////////////
+void lru_cache::set_live(handle entry) {
+    flags[entry] |= live;
+}
 
-// Based on https://www.boost.org/doc/libs/1_67_0/libs/multi_index/example/serialization.cpp
-/* Boost.MultiIndex example of serialization of a MRU list.
- *
- * Copyright 2003-2008 Joaquin M Lopez Munoz.
- * Distributed under the Boost Software License, Version 1.0.
- * (See accompanying file LICENSE_1_0.txt or copy at
- * http://www.boost.org/LICENSE_1_0.txt)
- *
- * See http://www.boost.org/libs/multi_index for library home page.
- */
-
-item_list::ctor_args_list lru_cache::get_init_tuple(const game_state& gs) {
-    return boost::make_tuple(
-            item_list::nth_index<0>::type::ctor_args(),
-            boost::make_tuple(
-                    size_t(0),
-                    multi_index::identity<cached_game_state>(),
-                    hasher(gs),
-                    equal_to<cached_game_state>()
-                    )
-            );
+bool lru_cache::is_live(handle entry) const {
+    return (flags[entry] & live) != 0;
 }
 
-lru_cache::lru_cache(const game_state& gs, uint64_t max_num_items_)
-        : max_num_items(max_num_items_), cache(get_init_tuple(gs)), states_removed_from_cache(0) {
+void lru_cache::set_unsearched(handle entry) {
+    set_non_live(entry);
+    searched_depths[entry] = 0;
 }
 
-pair<item_list::iterator, bool> lru_cache::insert(const game_state& gs) {
-    pair<item_list::iterator, bool> p = cache.push_front(cached_game_state(gs));
+uint64_t lru_cache::get_states_removed_from_cache() const {
+    return states_removed_from_cache;
+}
 
-    if(!p.second){                              /* duplicate item */
-        cache.relocate(cache.begin(), p.first); /* put in front */
-    } else if(cache.size() > max_num_items){    /* keep the length <= max_num_items */
+void lru_cache::enable_proof_numbers() {
+    assert(hash_lows.empty());
+    proofs_enabled = true;
+}
 
-        // If the least recently used node is 'live' (i.e. a parent), relocates
-        // it to the head of the list until this is no longer the case
-        for (uint64_t i = 0; prev(cache.end())->live; i++) {
-            cache.relocate(cache.begin(), prev(cache.end()));
+lru_cache::proof_numbers& lru_cache::get_proof_numbers(handle entry) {
+    assert(proofs_enabled);
+    return proofs[entry];
+}
 
-            if (i == max_num_items) {
-#ifndef NDEBUG
-                LOG_ERROR("All items in cache are live and cache is full");
-#endif
-                throw runtime_error("All items in cache are live and cache is full");
-            }
+// Returns the position of the slot holding the key, or of the empty slot
+// where it would be inserted
+lru_cache::size_type lru_cache::find_slot(const word* k, uint64_t hash) const {
+    auto hash_high = static_cast<uint32_t>(hash >> 32);
+    size_t key_bytes = packer.key_words() * sizeof(word);
+
+    for (size_type pos = home_slot(hash);; pos = (pos + 1) & slot_mask) {
+        const slot& s = slots[pos];
+        if (s.entry == empty
+            || (s.hash_high == hash_high && memcmp(key(s.entry), k, key_bytes) == 0)) {
+            return pos;
         }
-        cache.pop_back();
-        states_removed_from_cache++;
     }
-    return p;
 }
 
-bool lru_cache::contains(const game_state& gs) const {
-    return cache.get<1>().count(cached_game_state(gs)) > 0;
+// Only the lower half of the hash is used, as that is all that entries keep
+lru_cache::size_type lru_cache::home_slot(uint64_t hash) const {
+    return static_cast<uint32_t>(hash) & slot_mask;
 }
 
-void lru_cache::clear() {
-    cache.clear();
+lru_cache::word* lru_cache::key(handle entry) {
+    word* block = key_blocks[entry >> key_block_bits].data();
+    return block + (entry & ((1 << key_block_bits) - 1)) * packer.key_words();
 }
 
-item_list::size_type lru_cache::size() const {
-    return cache.size();
+const lru_cache::word* lru_cache::key(handle entry) const {
+    const word* block = key_blocks[entry >> key_block_bits].data();
+    return block + (entry & ((1 << key_block_bits) - 1)) * packer.key_words();
 }
 
-item_list::size_type lru_cache::bucket_count() const {
-    return cache.get<1>().bucket_count();
+void lru_cache::grow() {
+    vector<slot> old_slots(slots.size() * 2, slot{empty, 0});
+    swap(slots, old_slots);
+    slot_mask = slots.size() - 1;
+
+    // The low half of each hash is kept with its entry, so no keys need to
+    // be hashed again
+    for (const slot& s : old_slots) {
+        if (s.entry == empty) continue;
+
+        size_type pos = home_slot(hash_lows[s.entry]);
+        while (slots[pos].entry != empty) pos = (pos + 1) & slot_mask;
+        slots[pos] = s;
+    }
 }
 
-void lru_cache::set_non_live(item_list::iterator state_iter) {
-#ifndef NDEBUG
-    bool succ =
-#endif
-    cache.modify(state_iter, [](auto& v){ v.live = false; });
+// Removes a slot, shifting back any later slots in the same run which would
+// otherwise no longer be reachable from their home slot
+void lru_cache::erase_slot(size_type pos) {
+    for (size_type next = (pos + 1) & slot_mask;
+         slots[next].entry != empty;
+         next = (next + 1) & slot_mask) {
+
+        size_type home = home_slot(hash_lows[slots[next].entry]);
+        bool reachable = (pos <= next) ? (pos < home && home <= next)
+                                       : (pos < home || home <= next);
+        if (!reachable) {
+            slots[pos] = slots[next];
+            pos = next;
+        }
+    }
+    slots[pos] = slot{empty, 0};
+}
+
+// Advances the clock hand to the first entry which is neither live nor
+// referenced, clearing the referenced bit of the entries it passes, then
+// removes that entry from the table so that it can be reused
+lru_cache::handle lru_cache::evict() {
+    handle entry_count = static_cast<handle>(hash_lows.size());
+
+    for (uint64_t i = 0;; i++) {
+        if (i == 2 * uint64_t(entry_count)) {
 #ifndef NDEBUG
-    assert(succ);
+            LOG_ERROR("All items in cache are live and cache is full");
 #endif
-}
+            throw runtime_error("All items in cache are live and cache is full");
+        }
 
-uint64_t lru_cache::get_states_removed_from_cache() const {
-    return states_removed_from_cache;
+        handle entry = clock_hand;
+        clock_hand = (clock_hand + 1 == entry_count) ? 0 : clock_hand + 1;
+
+        if (flags[entry] & live) continue;
+        if (flags[entry] & referenced) {
+            flags[entry] &= ~referenced;
+            continue;
+        }
+
+        size_type pos = home_slot(hash_lows[entry]);
+        while (slots[pos].entry != entry) pos = (pos + 1) & slot_mask;
+        erase_slot(pos);
+        return entry;
+    }
 }
@@ -25,70 +25,126 @@
 #define SOLVITAIRE_GLOBAL_CACHE_H
 
 #include <vector>
-#include <unordered_set>
-#include <boost/pool/pool.hpp>
-#include <boost/pool/pool_alloc.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/identity.hpp>
-#include <boost/multi_index/hashed_index.hpp>
+
+#include <boost/optional.hpp>
 
 #include "sol_rules.h"
 #include "search-state/game_state.h"
 
-struct cached_game_state {
-    typedef std::vector<card> state_data;
-    typedef state_data::size_type size_type;
-
-    explicit cached_game_state(const game_state&);
-    void add_pile(pile::ref, const game_state&);
-    void add_pile_in_reverse(pile::ref, const game_state&);
-    void add_card(card, const game_state&);
-    void add_card_divider();
-
-    state_data data;
-    bool live; // Is a parent in the current search tree
-};
+// Packs a game state into the words of a cache key, reducing the suits of the
+// cards where the rules and streamliners allow it. Each card, and each divider
+// between piles, is packed into 6 bits. The number of words a key takes up is
+// fixed for a given set of rules, so keys can be compared with a single memcmp
+class key_packer {
+public:
+    typedef uint64_t word;
+    static const uint8_t item_bits;
 
-bool operator==(const cached_game_state&, const cached_game_state&);
+    explicit key_packer(const game_state&);
+    uint8_t key_words() const;
+    void pack(const game_state&, word*) const;
 
-struct hasher {
-    explicit hasher(const game_state&);
-    std::size_t operator() (const cached_game_state&) const;
+private:
+    struct writer;
 
-    std::size_t hash_value(const card&) const;
-    std::size_t combine(std::size_t&, std::size_t) const;
+    void add_pile(writer&, pile::ref, const game_state&) const;
+    void add_pile_in_reverse(writer&, pile::ref, const game_state&) const;
+    void add_card(writer&, card) const;
+    void add_card_divider(writer&) const;
 
-    const game_state& init_gs;
+    uint8_t suit_mask;
+    uint8_t words;
 };
 
+// An open-addressing hash table of the states seen by the solver, using the
+// hash kept by each game state. The keys of the entries are stored one after
+// another at the width given by the key packer, and the table itself only
+// holds entry indices, with part of the hash to avoid most key comparisons.
+// Once the cache is full, entries are evicted using the CLOCK algorithm as an
+// approximation of least recently used, skipping entries which are live. For
+// depth-limited search, each entry also records the depth it was searched to
+// below its state, and for proof-number search, the proof and disproof
+// numbers of its state
 class lru_cache {
 public:
-    typedef boost::multi_index::multi_index_container<
-            cached_game_state,
-            boost::multi_index::indexed_by<
-                    boost::multi_index::sequenced<>,
-                    boost::multi_index::hashed_unique<
-                            boost::multi_index::identity<cached_game_state>,
-                            hasher
-                    >
-            >
-    > item_list;
+    typedef uint32_t handle;
+    typedef uint64_t size_type;
+
+    struct proof_numbers {
+        uint64_t proof;
+        uint64_t disproof;
+    };
 
     explicit lru_cache(const game_state&, uint64_t);
-    std::pair<item_list::iterator, bool> insert(const game_state&);
+    std::pair<handle, bool> insert(const game_state&);
+    // Inserts a state with the depth left to search below it. The state needs
+    // searching if it is new, or was searched to less depth and isn't live
+    std::pair<handle, bool> insert(const game_state&, uint32_t);
     bool contains(const game_state&) const;
+    // Whether inserting the state with the depth left would find it needs no
+    // more searching, without inserting it
+    bool covers(const game_state&, uint32_t);
+    // Looks up a state without inserting it
+    boost::optional<handle> find(const game_state&);
+    // Whether an entry has the hash, so a state with it may be in the cache.
+    // No keys are compared, so this can be true of a state which isn't
+    bool may_contain(uint64_t) const;
     void clear();
-    item_list::size_type size() const;
-    item_list::size_type bucket_count() const;
-    void set_non_live(item_list::iterator);
+    size_type size() const;
+    size_type bucket_count() const;
+    void set_non_live(handle);
+    void set_live(handle);
+    bool is_live(handle) const;
+    // For a live state whose search was cut short
+    void set_unsearched(handle);
     uint64_t get_states_removed_from_cache() const;
 
+    // Keeps proof and disproof numbers for the entries inserted from then on.
+    // They are zero until set
+    void enable_proof_numbers();
+    proof_numbers& get_proof_numbers(handle);
+
 private:
-    static item_list::ctor_args_list get_init_tuple(const game_state&);
+    typedef key_packer::word word;
+
+    // The upper half of the hash is kept in the slot, and the lower half
+    // (from which the slot position is taken) in the entry
+    struct slot {
+        handle entry;
+        uint32_t hash_high;
+    };
+
+    static const handle empty;
+    static const uint8_t live;
+    static const uint8_t referenced;
+
+    size_type find_slot(const word*, uint64_t) const;
+    size_type home_slot(uint64_t) const;
+    word* key(handle);
+    const word* key(handle) const;
+    void grow();
+    void erase_slot(size_type);
+    handle evict();
 
     uint64_t max_num_items;
-    item_list cache;
+    size_type max_slots;
+    key_packer packer;
+    mutable std::vector<word> scratch;
+
+    // Entries. The keys are allocated in blocks, so none need to be moved
+    // as the cache fills
+    std::vector<std::vector<word>> key_blocks;
+    std::vector<uint32_t> hash_lows;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> searched_depths;
+    bool proofs_enabled;
+    std::vector<proof_numbers> proofs;
+    handle clock_hand;
+
+    // Table
+    std::vector<slot> slots;
+    size_type slot_mask;
+
     uint64_t states_removed_from_cache;
 };
 
@@ -24,7 +24,7 @@
 #include "move.h"
 
 move::move(mtype ty, pile::ref f, pile::ref t, int8_t count_, bool reveal_move_, bool flip_waste_, bool dominance_move_) :
-        type(ty), from(f), to(t), count(count_), reveal_move(reveal_move_), flip_waste(flip_waste_), dominance_move(dominance_move_) { 
+        from(f), to(t), count(count_), type(ty), reveal_move(reveal_move_), flip_waste(flip_waste_), dominance_move(dominance_move_) {
 #ifndef NDEBUG
     if (ty == mtype::regular)      assert(count == 1);
     if (ty == mtype::stock_k_plus) assert(!reveal_move_);
@@ -35,15 +35,18 @@ struct move {
     void make_reveal_move();
     void make_dominance_move();
 
-    mtype type;
+    // The fields are packed into 4 bytes, as moves fill the solver's move stack
     pile::ref from;
     pile::ref to;
     // For built piles the size of the pile, or for stock k-plus moves,
     // the number of cards to be moved from the stock to the waste before the waste card is played on the foundations
     int8_t count;
-    bool reveal_move;
-    bool flip_waste;
-    bool dominance_move;
+    mtype type : 3;
+    bool reveal_move : 1;
+    bool flip_waste : 1;
+    bool dominance_move : 1;
 };
 
+static_assert(sizeof(move) == 4, "moves should pack into 4 bytes");
+
 #endif //SOLVITAIRE_MOVE_H
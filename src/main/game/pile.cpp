@@ -23,89 +23,91 @@
 
 #include <vector>
 #include <ostream>
+#include <algorithm>
 
 #include "pile.h"
 
 using namespace std;
 
 const pile::size_type pile::max_size_type = 255;
+constexpr pile::size_type pile::capacity;
 
-pile::pile(std::vector<card> pv) : pile_vec(pv) {
+pile::pile() : cards(), pile_size(0) {
 }
 
-pile::pile(std::initializer_list<card> il) : pile_vec(il) {
+pile::pile(std::vector<card> pv) : pile() {
+    for (card c : pv) place(c);
+}
+
+pile::pile(std::initializer_list<card> il) : pile() {
+    for (card c : il) place(c);
 }
 
 card pile::top_card() const {
     assert(!empty());
-    return pile_vec.back();
+    return cards[pile_size - 1];
 }
 
 bool pile::empty() const {
-    return pile_vec.empty();
+    return pile_size == 0;
 }
 
 pile::size_type pile::size() const {
-    return static_cast<uint8_t>(pile_vec.size());
+    return pile_size;
 }
 
 card& pile::operator[] (size_type i) {
-    return pile_vec[pile_vec.size() - 1 - i];
+    assert(i < pile_size);
+    return cards[pile_size - 1 - i];
 }
 
 card pile::operator[] (size_type i) const {
-    vector<card>::size_type s = pile_vec.size() - 1 - i;
-    assert(s < pile_vec.size());
-    return pile_vec[s];
+    assert(i < pile_size);
+    return cards[pile_size - 1 - i];
 }
 
 void pile::place(const card c) {
-    pile_vec.emplace_back(c);
+    assert(pile_size < capacity);
+    cards[pile_size++] = c;
 }
 
 card pile::take() {
     assert(!empty());
-    card c = top_card();
-    pile_vec.pop_back();
-    return c;
+    return cards[--pile_size];
+}
+
+const card* pile::begin() const {
+    return cards.data();
+}
+
+const card* pile::end() const {
+    return cards.data() + pile_size;
 }
 
 bool operator==(const pile& a, const pile& b) {
-    return a.pile_vec == b.pile_vec;
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin());
 }
 
 bool operator!=(const pile& a, const pile& b) {
-    return a.pile_vec != b.pile_vec;
+    return !(a == b);
 }
 
 bool operator<(const pile& a, const pile& b) {
     if (a.size() == b.size()) {
-        return a.pile_vec < b.pile_vec;
+        return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
     } else {
         return a.size() < b.size();
     }
 }
 
 bool operator>(const pile& a, const pile& b) {
-    if (a.size() == b.size()) {
-        return a.pile_vec > b.pile_vec;
-    } else {
-        return a.size() > b.size();
-    }
+    return b < a;
 }
 
 bool operator<=(const pile& a, const pile& b) {
-    if (a.size() == b.size()) {
-        return a.pile_vec <= b.pile_vec;
-    } else {
-        return a.size() <= b.size();
-    }
+    return !(b < a);
 }
 
 bool operator>=(const pile& a, const pile& b) {
-    if (a.size() == b.size()) {
-        return a.pile_vec >= b.pile_vec;
-    } else {
-        return a.size() >= b.size();
-    }
+    return !(a < b);
 }
@@ -25,21 +25,23 @@
 #define SOLVITAIRE_PILE_H
 
 #include <vector>
+#include <array>
 #include <iterator>
 
 #include "sol_rules.h"
 #include "card.h"
 
 class pile {
-    friend class hasher;
     friend class game_state;
-    friend class cached_game_state;
+    friend class key_packer;
 public:
     typedef uint8_t size_type;
     const static size_type max_size_type;
     typedef uint8_t ref;
+    // The most cards a pile can hold, which is every card of two decks
+    constexpr static size_type capacity = 104;
 
-    pile() = default;
+    pile();
     pile(std::vector<card>);
     pile(std::initializer_list<card>);
 
@@ -64,8 +66,14 @@ public:
     card take();
 
 private:
-    // Underlying vector
-    std::vector<card> pile_vec;
+    // The cards from the bottom of the pile up
+    const card* begin() const;
+    const card* end() const;
+
+    // The cards are held inline, so that the piles of a game state share one
+    // block of memory
+    std::array<card, capacity> cards;
+    size_type pile_size;
 };
 
 
@@ -0,0 +1,90 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SOLVITAIRE_PILE_REF_LIST_H
+#define SOLVITAIRE_PILE_REF_LIST_H
+
+#include <array>
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+
+#include "pile.h"
+
+// An ordered list of pile references, held inline. The capacity is the most
+// piles of one kind that any preset has (the 52 accordion piles), so that
+// copying a state stays cheap. Rules needing more are rejected by game_state
+class pile_ref_list {
+public:
+    typedef pile::ref* iterator;
+    typedef const pile::ref* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef uint8_t size_type;
+
+    constexpr static size_type capacity = 52;
+
+    pile_ref_list() : refs(), list_size(0) {}
+
+    iterator begin() { return refs.data(); }
+    iterator end() { return refs.data() + list_size; }
+    const_iterator begin() const { return refs.data(); }
+    const_iterator end() const { return refs.data() + list_size; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    bool empty() const { return list_size == 0; }
+    size_type size() const { return list_size; }
+    pile::ref front() const { assert(!empty()); return refs[0]; }
+    pile::ref operator[](size_type i) const { assert(i < list_size); return refs[i]; }
+    pile::ref& operator[](size_type i) { assert(i < list_size); return refs[i]; }
+
+    void push_back(pile::ref pr) {
+        assert(list_size < refs.size());
+        refs[list_size++] = pr;
+    }
+
+    // Inserts the reference before the given position
+    void insert(iterator pos, pile::ref pr) {
+        assert(list_size < refs.size());
+        std::copy_backward(pos, end(), end() + 1);
+        *pos = pr;
+        list_size++;
+    }
+
+    void erase(iterator pos) {
+        std::copy(pos + 1, end(), pos);
+        list_size--;
+    }
+
+    // Removes the reference, which must be in the list
+    void remove(pile::ref pr) {
+        iterator pos = std::find(begin(), end(), pr);
+        assert(pos != end());
+        erase(pos);
+    }
+
+private:
+    std::array<pile::ref, capacity> refs;
+    size_type list_size;
+};
+
+#endif //SOLVITAIRE_PILE_REF_LIST_H
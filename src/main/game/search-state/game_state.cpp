@@ -40,8 +40,8 @@
 
 using namespace rapidjson;
 using std::vector;
-using std::list;
 using std::find;
+using std::upper_bound;
 using std::begin;
 using std::end;
 using std::rbegin;
@@ -51,6 +51,7 @@ using std::max;
 using std::ostream;
 using std::mt19937;
 using std::string;
+using std::to_string;
 
 typedef sol_rules::build_policy pol;
 typedef sol_rules::stock_deal_type sdt;
@@ -71,6 +72,15 @@ game_state::game_state(const sol_rules& s_rules, streamliner_options stream_opts
         , stock(255)
         , waste(255)
         , hole (255) {
+    uint8_t reserve_piles = rules.reserve_stacked ? uint8_t(1) : rules.reserve_size;
+    if (rules.tableau_pile_count > pile_ref_list::capacity
+        || rules.cells > pile_ref_list::capacity
+        || reserve_piles > pile_ref_list::capacity
+        || rules.accordion_size > pile_ref_list::capacity) {
+        throw runtime_error("Error: too many piles of one kind (the most is "
+                            + to_string(pile_ref_list::capacity) + ")");
+    }
+
     // If there is a hole, creates pile
     if (rules.hole) {
         piles.emplace_back();
@@ -138,12 +148,15 @@ game_state::game_state(const sol_rules& s_rules, streamliner_options stream_opts
         piles.emplace_back();
         sequences.push_back(static_cast<pile::ref>(piles.size() - 1));
     }
+
+    init_hashing();
 }
 
 // Constructs an initial game state from a JSON doc
 game_state::game_state(const sol_rules& s_rules, const Document& doc, streamliner_options s_opts)
         : game_state(s_rules, s_opts) {
     deal_parser::parse(*this, doc);
+    hash.accordion = hash_accordion();
 }
 
 // Constructs an initial game state from a seed
@@ -242,6 +255,7 @@ game_state::game_state(const sol_rules& s_rules, int seed, streamliner_options s
             place_card(pr, deck.back());
             deck.pop_back();
         }
+        hash.accordion = hash_accordion();
     }
 
     // This only occurs during testing
@@ -277,9 +291,9 @@ game_state::game_state(const sol_rules& s_rules, int seed, streamliner_options s
 
     // Now if necessary, turns the top cards face up
     if (rules.face_up == fu::TOP_CARDS)
-        for (auto& p : piles)
-            if (!p.empty())
-                p[0].turn_face_up();
+        for (pile::ref pr = 0; pr < piles.size(); pr++)
+            if (!piles[pr].empty())
+                turn_face_up(pr);
 
     // The size of all piles must equal the deck size
     int piles_sz = 0;
@@ -299,6 +313,7 @@ game_state::game_state(const sol_rules& s_rules,
         }
         pr++;
     }
+    hash.accordion = hash_accordion();
 
     // Sets foundations base appropriately
     if (rules.foundations_present && rules.foundations_base == boost::none) {
@@ -380,6 +395,7 @@ void game_state::make_move(const move m) {
 
 #ifndef NDEBUG
     check_face_down_consistent();
+    check_hash_consistent();
 #endif
 }
 
@@ -410,6 +426,7 @@ void game_state::undo_move(const move m) {
 
 #ifndef NDEBUG
     check_face_down_consistent();
+    check_hash_consistent();
 #endif
 }
 
@@ -422,7 +439,7 @@ void game_state::make_regular_move(const move m) {
     if (m.reveal_move) {
         assert(!piles[m.from].empty());
         assert(piles[m.from][0].is_face_down());
-        piles[m.from][0].turn_face_up();
+        turn_face_up(m.from);
     }
 
 }
@@ -433,7 +450,7 @@ void game_state::undo_regular_move(const move m) {
     if (m.reveal_move) {
         assert(!piles[m.from].empty());
         assert(!piles[m.from][0].is_face_down());
-        piles[m.from][0].turn_face_down();
+        turn_face_down(m.from);
     }
 
     place_card(m.from, take_card(m.to));
@@ -457,7 +474,7 @@ void game_state::make_built_group_move(move m) {
     if (m.reveal_move) {
         assert(!piles[m.from].empty());
         assert(piles[m.from][0].is_face_down());
-        piles[m.from][0].turn_face_up();
+        turn_face_up(m.from);
     }
 }
 
@@ -467,7 +484,7 @@ void game_state::undo_built_group_move(move m) {
     if (m.reveal_move) {
         assert(!piles[m.from].empty());
         assert(!piles[m.from][0].is_face_down());
-        piles[m.from][0].turn_face_down();
+        turn_face_down(m.from);
     }
 
     // Adds the cards to the 'from' pile
@@ -581,40 +598,64 @@ void game_state::make_sequence_move(const move m) {
     pile::ref from_seq_ref = m.from / rules.max_rank;
     pile::size_type from_card_idx = m.from % rules.max_rank;
     card from_card = piles[from_seq_ref][from_card_idx];
-    piles[from_seq_ref][from_card_idx] = "AS";
+    replace_card(from_seq_ref, from_card_idx, "AS");
 
     pile::ref to_seq_ref = m.to / rules.max_rank;
     pile::size_type to_card_idx = m.to % rules.max_rank;
     assert(piles[to_seq_ref][to_card_idx] == "AS");
-    piles[to_seq_ref][to_card_idx] = from_card;
+    replace_card(to_seq_ref, to_card_idx, from_card);
 }
 
 void game_state::undo_sequence_move(const move m) {
     pile::ref to_seq_ref = m.to / rules.max_rank;
     pile::size_type to_card_idx = m.to % rules.max_rank;
     card to_card = piles[to_seq_ref][to_card_idx];
-    piles[to_seq_ref][to_card_idx] = "AS";
+    replace_card(to_seq_ref, to_card_idx, "AS");
 
     pile::ref from_seq_ref = m.from / rules.max_rank;
     pile::size_type from_card_idx = m.from % rules.max_rank;
     assert(piles[from_seq_ref][from_card_idx] == "AS");
-    piles[from_seq_ref][from_card_idx] = to_card;
+    replace_card(from_seq_ref, from_card_idx, to_card);
 }
 
 void game_state::make_accordion_move(move m) {
     make_built_group_move(m);
     accordion.remove(m.from);
+    hash.accordion = hash_accordion();
 }
 
 void game_state::undo_accordion_move(move m) {
     accordion.insert(upper_bound(begin(accordion), end(accordion), m.from), m.from);
     undo_built_group_move(m);
+    hash.accordion = hash_accordion();
+}
+
+// Turns the top card of a pile over, keeping the hash up to date
+void game_state::turn_face_up(pile::ref pr) {
+    hash_card(hash, pr, piles[pr].size() - 1, piles[pr][0], false);
+    piles[pr][0].turn_face_up();
+    hash_card(hash, pr, piles[pr].size() - 1, piles[pr][0], true);
+}
+
+void game_state::turn_face_down(pile::ref pr) {
+    hash_card(hash, pr, piles[pr].size() - 1, piles[pr][0], false);
+    piles[pr][0].turn_face_down();
+    hash_card(hash, pr, piles[pr].size() - 1, piles[pr][0], true);
+}
+
+// Replaces the card at the given index (from the top) of a pile
+void game_state::replace_card(pile::ref pr, pile::size_type idx, card c) {
+    auto pos = static_cast<pile::size_type>(piles[pr].size() - 1 - idx);
+    hash_card(hash, pr, pos, piles[pr][idx], false);
+    piles[pr][idx] = c;
+    hash_card(hash, pr, pos, c, true);
 }
 
 // Places a card on a pile and if it is on a tableau, cell or reserve pile,
 // reorders the pile refs so that the largest pile is first
 void game_state::place_card(pile::ref pr, card c) {
     piles[pr].place(c);
+    hash_card(hash, pr, piles[pr].size() - 1, c, true);
 
 #ifndef NO_PILE_SYMMETRY
     // If the stock deals to the tableau piles, there is no pile symmetry
@@ -627,6 +668,7 @@ void game_state::place_card(pile::ref pr, card c) {
 // Same as above but for taking cards
 card game_state::take_card(pile::ref pr) {
     card c = piles[pr].take();
+    hash_card(hash, pr, piles[pr].size(), c, false);
 #ifndef NO_PILE_SYMMETRY
     // If the stock deals to the tableau piles, there is no pile symmetry
     if (rules.stock_size == 0 || rules.stock_deal_t != sdt::TABLEAU_PILES) {
@@ -645,7 +687,7 @@ void game_state::check_face_down_consistent() const {
 
         // Makes sure face down cards are never above face down ones
         bool seen_face_up = false;
-        for (auto& c : piles[p].pile_vec) {
+        for (auto& c : piles[p]) {
             seen_face_up = seen_face_up || !c.is_face_down();
             assert(!(c.is_face_down() && seen_face_up));
         }
@@ -724,6 +766,25 @@ const std::vector<pile>& game_state::get_data() const {
     return piles;
 }
 
+game_state::pile_kind game_state::get_pile_kind(pile::ref pr) const {
+    assert(pr < piles.size());
+    auto in = [pr](const vector<pile::ref>& refs) {
+        return find(begin(refs), end(refs), pr) != end(refs);
+    };
+
+    if (pr == hole) return pile_kind::HOLE;
+    if (pr == stock) return pile_kind::STOCK;
+    if (pr == waste) return pile_kind::WASTE;
+    if (in(foundations)) return pile_kind::FOUNDATION;
+    if (in(original_cells)) return pile_kind::CELL;
+    if (in(original_reserve)) return pile_kind::RESERVE;
+    if (in(original_tableau_piles)) return pile_kind::TABLEAU;
+    if (in(sequences)) return pile_kind::SEQUENCE;
+    // Accordion piles are dropped from the list as they empty, so are the
+    // only ones left
+    return pile_kind::ACCORDION;
+}
+
 
 ///////////
 // PRINT //
@@ -25,7 +25,6 @@
 #define SOLVITAIRE_GAME_STATE_H
 
 #include <vector>
-#include <list>
 #include <string>
 #include <random>
 #include <functional>
@@ -36,19 +35,20 @@
 #include "document.h"
 #include "../card.h"
 #include "../pile.h"
+#include "../pile_ref_list.h"
 #include "../sol_rules.h"
 #include "../move.h"
 
 class game_state {
-    friend class hasher;
     friend class global_cache;
-    friend class cached_game_state;
+    friend class key_packer;
     friend class deal_parser;
     friend class state_printer;
     friend class test_helper;
     friend class json_helper;
 public:
     enum class streamliner_options {NONE, AUTO_FOUNDATIONS, SUIT_SYMMETRY, BOTH};
+    enum class pile_kind {HOLE, FOUNDATION, CELL, STOCK, WASTE, RESERVE, ACCORDION, TABLEAU, SEQUENCE};
 
     /* Constructors */
 
@@ -69,12 +69,25 @@ public:
     /* Legal move generation */
 
     std::vector<move> get_legal_moves(move = move(move::mtype::regular));
+    // Appends the legal moves to the supplied vector, leaving its contents
+    void get_legal_moves(std::vector<move>&, move = move(move::mtype::regular));
     boost::optional<move> get_dominance_move() const;
 
     /* State inspection */
 
     bool is_solved() const;
+    // A lower bound on the number of moves left to solve the state
+    uint32_t min_moves_to_solve() const;
+    // An estimate of how far the state is from being solved, which unlike the
+    // lower bound may be too high, for ordering a best-first search
+    uint32_t distance_estimate() const;
     const std::vector<pile>& get_data() const;
+    // The part of the layout a pile belongs to
+    pile_kind get_pile_kind(pile::ref) const;
+    uint64_t get_hash() const;
+    // The hash the state would have after the move, worked out without making
+    // it. Only given for moves of cards between piles hashed by their contents
+    boost::optional<uint64_t> hash_after(move) const;
 
     /* Printing */
 
@@ -90,10 +103,37 @@ private:
     /* Pile order logic */
 
     void eval_pile_order(pile::ref, bool);
-    void eval_pile_order(std::list<pile::ref>&, pile::ref, bool);
+    void eval_pile_order(pile_ref_list&, pile::ref, bool);
+
+    /* Hashing */
+
+    // The parts of the hash of the state, kept up to date as cards are placed,
+    // taken and turned over. Piles whose order doesn't matter are combined by
+    // addition, and the stock and waste with a polynomial hash so that cards
+    // moving between the two leave the hash unchanged
+    struct hash_parts {
+        std::vector<uint64_t> pile_hashes;
+        uint64_t piles;
+        uint64_t stock;
+        uint64_t waste;
+        uint64_t accordion;
+    };
+
+    void init_hashing();
+    uint8_t card_code(card) const;
+    void hash_card(hash_parts&, pile::ref, pile::size_type, card, bool) const;
+    uint64_t hash_accordion() const;
+    uint64_t combine_hash(const hash_parts&) const;
+    hash_parts calc_hash() const;
+#ifndef NDEBUG
+    void check_hash_consistent() const;
+#endif
 
     /* Altering state */
 
+    void turn_face_up(pile::ref);
+    void turn_face_down(pile::ref);
+    void replace_card(pile::ref, pile::size_type, card);
     void make_regular_move(move move);
     void undo_regular_move(move move);
     void make_built_group_move(move move);
@@ -148,8 +188,17 @@ private:
     bool tableau_space_and_auto_reserve() const;
 
     bool is_next_legal_card(sol_rules::build_policy, card, card) const;
-    bool is_next_legal_card(std::vector<sol_rules::accordion_policy>, card, card) const;
-    void turn_face_down_cards(std::vector<move>&) const;
+    bool is_next_legal_card(const std::vector<sol_rules::accordion_policy>&, card, card) const;
+    void turn_face_down_cards(std::vector<move>&, std::vector<move>::size_type) const;
+
+    /* Heuristics (lower bounds on the moves left for each type of game) */
+
+    uint32_t cards_not_in_hole() const;
+    uint32_t cards_not_on_foundations() const;
+    uint32_t complete_piles_not_on_foundations() const;
+    uint32_t cards_buried_by_lower_cards() const;
+    uint32_t face_down_cards() const;
+    uint32_t filled_tableau_piles() const;
 
     /* Auto-foundation moves */
 
@@ -168,14 +217,14 @@ private:
 
     /* Pile references */
 
-    std::list<pile::ref> tableau_piles;
-    std::list<pile::ref> cells;
+    pile_ref_list tableau_piles;
+    pile_ref_list cells;
     pile::ref stock;
     pile::ref waste;
-    std::list<pile::ref> reserve;
+    pile_ref_list reserve;
     std::vector<pile::ref> foundations;
     std::vector<pile::ref> sequences;
-    std::list<pile::ref> accordion;
+    pile_ref_list accordion;
     pile::ref hole;
 
     /* Pile references of starting/original layout */
@@ -187,6 +236,12 @@ private:
     /* Core piles */
 
     std::vector<pile> piles;
+
+    /* Hashing */
+
+    uint8_t suit_mask;
+    std::vector<uint64_t> hash_salts;
+    hash_parts hash;
 };
 
 #endif //SOLVITAIRE_GAME_STATE_H
@@ -0,0 +1,285 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#include "game_state.h"
+
+typedef sol_rules::build_policy pol;
+typedef sol_rules::stock_deal_type sdt;
+typedef game_state::streamliner_options sos;
+
+// Constants used to separate the hashes of the different parts of the state
+static const uint64_t tableau_salt   = 0x5851f42d4c957f2d;
+static const uint64_t cell_salt      = 0x14057b7ef767814f;
+static const uint64_t reserve_salt   = 0x2545f4914f6cdd1d;
+static const uint64_t sequence_salt  = 0x9e3779b97f4a7c15;
+static const uint64_t stock_salt     = 0xd1b54a32d192ed03;
+static const uint64_t waste_salt     = 0x8cb92ba72f3d8dd7;
+static const uint64_t hole_salt      = 0xaef17502108ef2d9;
+static const uint64_t accordion_salt = 0xdb4f0b9175ae2165;
+
+// The odd base of the polynomial hash of the stock and waste
+static const uint64_t stock_base     = 0x9fb21c651e98df25;
+
+// A 64 bit mixing function (the finaliser of SplitMix64), used in place of a
+// table of random numbers
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+// The powers of the stock base, and of its inverse
+typedef std::array<uint64_t, 256> power_table; // One for each possible pile size
+
+static power_table calc_powers(uint64_t base) {
+    power_table powers;
+    powers[0] = 1;
+    for (size_t i = 1; i < powers.size(); i++) {
+        powers[i] = powers[i - 1] * base;
+    }
+    return powers;
+}
+
+static uint64_t inverse(uint64_t odd) {
+    // Newton's method, which doubles the number of correct bits each time
+    uint64_t inv = odd;
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - odd * inv;
+    }
+    return inv;
+}
+
+static const power_table& stock_powers() {
+    static const power_table powers = calc_powers(stock_base);
+    return powers;
+}
+
+static const power_table& waste_powers() {
+    static const power_table powers = calc_powers(inverse(stock_base));
+    return powers;
+}
+
+// Works out how each pile is hashed. Piles which are kept in order by the
+// pile order logic share a salt, so that only the contents of the piles, and
+// not their positions, matter. The suits of the cards are reduced in the same
+// way as in the cache
+void game_state::init_hashing() {
+    bool is_suit_symmetry = (rules.foundations_present
+            && (stream_opts == sos::SUIT_SYMMETRY || stream_opts == sos::BOTH))
+            || rules.hole;
+
+    // As clubs and spades are 0 and 2, and hearts and diamonds are 1 and 3,
+    // masking the suit with 1 gives the colour
+    if (!is_suit_symmetry || rules.build_pol == pol::SAME_SUIT) {
+        suit_mask = 3;
+    } else if (rules.build_pol == pol::RED_BLACK) {
+        suit_mask = 1;
+    } else {
+        suit_mask = 0;
+    }
+
+    bool pile_symmetry = rules.stock_size == 0 || rules.stock_deal_t != sdt::TABLEAU_PILES;
+#ifdef NO_PILE_SYMMETRY
+    pile_symmetry = false;
+#endif
+
+    hash_salts.assign(piles.size(), 0);
+    for (pile::ref pr : original_tableau_piles) {
+        hash_salts[pr] = pile_symmetry ? tableau_salt : mix(tableau_salt + pr);
+    }
+    for (pile::ref pr : original_cells) {
+        hash_salts[pr] = cell_salt;
+    }
+    for (pile::ref pr : original_reserve) {
+        hash_salts[pr] = reserve_salt;
+    }
+    for (pile::ref pr : sequences) {
+        hash_salts[pr] = mix(sequence_salt + pr);
+    }
+
+    hash.pile_hashes.assign(piles.size(), 0);
+    hash.piles = 0;
+    hash.stock = 0;
+    hash.waste = 0;
+    hash.accordion = 0;
+}
+
+uint8_t game_state::card_code(card c) const {
+    return static_cast<uint8_t>(c.get_rank() * 8 + (c.get_suit() & suit_mask) * 2
+                                + c.is_face_down());
+}
+
+// Adds or removes a card at the given position (from the bottom) of a pile
+// to or from the hash
+void game_state::hash_card(hash_parts& parts, pile::ref pr, pile::size_type pos,
+                           card c, bool add) const {
+    if (hash_salts[pr] != 0) {
+        // The hash of each pile is the xor of its cards. A pile adds to the
+        // overall hash by its mixed hash, less that of an empty pile
+        uint64_t salt = hash_salts[pr];
+        uint64_t old_hash = parts.pile_hashes[pr];
+        uint64_t new_hash = old_hash ^ mix((uint64_t(pos) << 8 | card_code(c)) + salt);
+
+        parts.piles += mix(new_hash ^ salt) - mix(old_hash ^ salt);
+        parts.pile_hashes[pr] = new_hash;
+    } else if (pr == stock || pr == waste) {
+        // The stock is hashed from the bottom up, then the waste from the top
+        // down (as in the cache). The waste hash uses inverse powers, and is
+        // shifted into place when the hash is combined
+        bool is_stock = pr == stock;
+        uint64_t value = mix(card_code(c) + stock_salt);
+        uint64_t term = value * (is_stock ? stock_powers() : waste_powers())[pos];
+        uint64_t& target = is_stock ? parts.stock : parts.waste;
+
+        if (add) target += term;
+        else     target -= term;
+    }
+
+    // The hole and accordion are hashed from their top cards when needed, and
+    // the foundations can be deduced from the rest of the state
+}
+
+uint64_t game_state::hash_accordion() const {
+    uint64_t h = 0;
+    uint64_t idx = 0;
+    for (pile::ref pr : accordion) {
+        if (!piles[pr].empty()) {
+            h += mix((idx << 8 | card_code(piles[pr].top_card())) + accordion_salt);
+        }
+        idx++;
+    }
+    return h;
+}
+
+uint64_t game_state::combine_hash(const hash_parts& parts) const {
+    uint64_t h = parts.piles + parts.accordion;
+
+    if (rules.stock_size > 0) {
+        uint64_t total = piles[stock].size();
+        if (waste != 255) total += piles[waste].size();
+
+        h += parts.stock;
+        if (total > 0) {
+            h += stock_powers()[total - 1] * parts.waste;
+        }
+
+        // Without waste deal symmetry, the split between the stock and the
+        // waste matters
+        if (rules.stock_deal_t == sdt::WASTE) {
+            bool waste_deal_symmetry = rules.stock_redeal
+                    && piles[waste].size() % rules.stock_deal_count == 0;
+            if (!waste_deal_symmetry) {
+                h += mix(piles[stock].size() + waste_salt);
+            }
+        }
+    }
+
+    if (rules.hole && !piles[hole].empty()) {
+        h += mix(card_code(piles[hole].top_card()) + hole_salt);
+    }
+
+    return h;
+}
+
+uint64_t game_state::get_hash() const {
+    return combine_hash(hash);
+}
+
+// Applies the changes the move would make to the hashes of its two piles to a
+// copy of them. Moves involving the stock, waste or accordion also change
+// parts of the hash which depend on the rest of the state, so aren't handled
+boost::optional<uint64_t> game_state::hash_after(const move m) const {
+    if (m.type != move::mtype::regular && m.type != move::mtype::built_group) return boost::none;
+
+    auto is_foundation = [this](pile::ref pr) {
+        return std::find(begin(foundations), end(foundations), pr) != end(foundations);
+    };
+    bool to_hole = rules.hole && m.to == hole;
+    if (!(hash_salts[m.from] != 0 || is_foundation(m.from))
+        || !(hash_salts[m.to] != 0 || is_foundation(m.to) || to_hole)) {
+        return boost::none;
+    }
+
+    const pile& from_pile = piles[m.from];
+    const pile& to_pile = piles[m.to];
+    auto count = static_cast<pile::size_type>(m.count);
+    uint64_t from_hash = hash.pile_hashes[m.from];
+    uint64_t to_hash = hash.pile_hashes[m.to];
+
+    auto flip = [this](uint64_t& pile_hash, pile::ref pr, pile::size_type pos, card c) {
+        pile_hash ^= mix((uint64_t(pos) << 8 | card_code(c)) + hash_salts[pr]);
+    };
+    for (pile::size_type idx = 0; idx < count; idx++) {
+        flip(from_hash, m.from, static_cast<pile::size_type>(from_pile.size() - 1 - idx), from_pile[idx]);
+        flip(to_hash, m.to, static_cast<pile::size_type>(to_pile.size() + count - 1 - idx), from_pile[idx]);
+    }
+    if (m.reveal_move) {
+        auto pos = static_cast<pile::size_type>(from_pile.size() - 1 - count);
+        card c = from_pile[count];
+        flip(from_hash, m.from, pos, c);
+        c.turn_face_up();
+        flip(from_hash, m.from, pos, c);
+    }
+
+    uint64_t h = get_hash();
+    for (auto changed : {std::make_pair(m.from, from_hash), std::make_pair(m.to, to_hash)}) {
+        uint64_t salt = hash_salts[changed.first];
+        if (salt != 0) {
+            h += mix(changed.second ^ salt) - mix(hash.pile_hashes[changed.first] ^ salt);
+        }
+    }
+    if (to_hole) {
+        if (!to_pile.empty()) h -= mix(card_code(to_pile.top_card()) + hole_salt);
+        h += mix(card_code(from_pile[0]) + hole_salt);
+    }
+    return h;
+}
+
+// Calculates the hash of the state from scratch
+game_state::hash_parts game_state::calc_hash() const {
+    hash_parts parts;
+    parts.pile_hashes.assign(piles.size(), 0);
+    parts.piles = 0;
+    parts.stock = 0;
+    parts.waste = 0;
+
+    for (pile::ref pr = 0; pr < piles.size(); pr++) {
+        for (pile::size_type pos = 0; pos < piles[pr].size(); pos++) {
+            card c = piles[pr][static_cast<pile::size_type>(piles[pr].size() - 1 - pos)];
+            hash_card(parts, pr, pos, c, true);
+        }
+    }
+    parts.accordion = hash_accordion();
+
+    return parts;
+}
+
+#ifndef NDEBUG
+void game_state::check_hash_consistent() const {
+    assert(get_hash() == combine_hash(calc_hash()));
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <array>
+
+#include "game_state.h"
+
+typedef sol_rules::built_group_type bgt;
+
+// Each bound must never be more than the number of moves actually needed, or
+// a depth-limited search pruned with it could miss the shortest solution
+uint32_t game_state::min_moves_to_solve() const {
+    if (rules.hole) {
+        return cards_not_in_hole();
+    } else if (rules.foundations_present && rules.foundations_only_comp_piles) {
+        return complete_piles_not_on_foundations();
+    } else if (rules.foundations_present) {
+        return cards_not_on_foundations() + cards_buried_by_lower_cards();
+    } else if (rules.accordion_size > 0) {
+        return uint32_t(accordion.size()) - 1;
+    } else {
+        // Gaps-type games can solve several sequences at a time
+        return 0;
+    }
+}
+
+// Counts each move the lower bound is sure of twice, as most of the moves it
+// leaves out are for cards still face down or in the way, and adds a move for
+// every face-down card, which has to be uncovered, and for every tableau pile
+// which isn't empty, as empty piles give room to move cards
+uint32_t game_state::distance_estimate() const {
+    return 2 * min_moves_to_solve() + 2 * face_down_cards() + filled_tableau_piles();
+}
+
+// Every move puts at most one card into the hole
+uint32_t game_state::cards_not_in_hole() const {
+    return uint32_t(rules.max_rank) * 4 * (rules.two_decks ? 2 : 1) - piles[hole].size();
+}
+
+// Every move puts at most one card onto the foundations
+uint32_t game_state::cards_not_on_foundations() const {
+    uint32_t cards = uint32_t(rules.max_rank) * foundations.size();
+    for (pile::ref f : foundations) {
+        cards -= piles[f].size();
+    }
+    return cards;
+}
+
+// Every move puts at most one whole suit onto the foundations
+uint32_t game_state::complete_piles_not_on_foundations() const {
+    uint32_t piles_left = 0;
+    for (pile::ref f : foundations) {
+        if (piles[f].empty()) piles_left++;
+    }
+    return piles_left;
+}
+
+// A tableau card with a card of its suit below it which goes onto the
+// foundations first has to be moved off the pile before it can go up itself,
+// so needs at least two moves. This only holds when the cards leave the pile
+// one at a time, and when no other copy of the lower card can go up instead
+uint32_t game_state::cards_buried_by_lower_cards() const {
+    if (rules.two_decks || rules.move_built_group != bgt::NO) return 0;
+
+    uint32_t buried = 0;
+    for (pile::ref pr : tableau_piles) {
+        // The lowest rank of each suit seen so far, going up the pile
+        std::array<card::rank_t, 4> lowest;
+        lowest.fill(card::rank_t(rules.max_rank + 1));
+
+        for (card c : piles[pr]) {
+            card::suit_t s = c.get_suit();
+            card::rank_t r = foundation_base_convert(c.get_rank());
+
+            if (lowest[s] < r) buried++;
+            else lowest[s] = r;
+        }
+    }
+    return buried;
+}
+
+uint32_t game_state::face_down_cards() const {
+    uint32_t face_down = 0;
+    for (pile::ref pr : tableau_piles) {
+        for (card c : piles[pr]) {
+            if (c.is_face_down()) face_down++;
+        }
+    }
+    return face_down;
+}
+
+uint32_t game_state::filled_tableau_piles() const {
+    uint32_t filled = 0;
+    for (pile::ref pr : tableau_piles) {
+        if (!piles[pr].empty()) filled++;
+    }
+    return filled;
+}
@@ -30,7 +30,8 @@
 
 using std::vector;
 using std::min;
-using std::list;
+using std::begin;
+using std::end;
 using std::pair;
 using std::set;
 using std::greater;
@@ -48,8 +49,14 @@ typedef sol_rules::built_group_type bgt;
 // MAIN LEGAL MOVE GEN CYCLE ///
 ////////////////////////////////
 
-// Note that the moves added last here, are tried first
 vector<move> game_state::get_legal_moves(move parent_move) {
+    vector<move> moves;
+    get_legal_moves(moves, parent_move);
+    return moves;
+}
+
+// Note that the moves added last here, are tried first
+void game_state::get_legal_moves(vector<move>& moves, move parent_move) {
     // Order:
     // Stock waste deal type move
     // Accordion moves
@@ -69,7 +76,7 @@ vector<move> game_state::get_legal_moves(move parent_move) {
     // Stock-hole deal type move
 
 
-    vector<move> moves;
+    const auto first_move = moves.size();
 
     // Stock-hole deal type move
     if (rules.stock_deal_t == sdt::HOLE && !piles[stock].empty())
@@ -202,31 +209,29 @@ vector<move> game_state::get_legal_moves(move parent_move) {
         if (rules.stock_size > 0 && rules.stock_deal_t == sdt::WASTE && rules.stock_redeal)
             add_stock_to_hole_foundation_moves(moves);
 
-        list<pile::ref> from_piles = tableau_piles;
-        if (rules.cells > 0) from_piles.insert(from_piles.end(), cells.begin(), cells.end());
-        if (rules.reserve_size > 0) from_piles.insert(from_piles.end(), reserve.begin(), reserve.end());
-
-        for (auto fp : from_piles) {
-            if (piles[fp].empty() || (parent_move.to == fp && !parent_move.dominance_move)) continue;
+        auto add_from_pile_moves = [&](pile::ref fp) {
+            if (piles[fp].empty() || (parent_move.to == fp && !parent_move.dominance_move)) return;
 
             for (auto f : foundations)
                 if (is_valid_foundations_move(fp, f))
                     moves.emplace_back(move::mtype::regular, fp, f);
             if (rules.hole && is_valid_hole_move(fp))
                 moves.emplace_back(move::mtype::regular, fp, hole);
-        }
+        };
+
+        for (auto t : tableau_piles) add_from_pile_moves(t);
+        if (rules.cells > 0) for (auto c : cells) add_from_pile_moves(c);
+        if (rules.reserve_size > 0) for (auto r : reserve) add_from_pile_moves(r);
     }
 
     if (rules.foundations_only_comp_piles) // i.e. Spider-type winning condition
         add_foundation_complete_piles_moves(moves);
 
     if (rules.tableau_pile_count > 0 && rules.face_up != fu::ALL)
-        turn_face_down_cards(moves);
+        turn_face_down_cards(moves, first_move);
 
     if (rules.accordion_size > 0)
         add_accordion_moves(moves);
-
-    return moves;
 }
 
 
@@ -302,7 +307,7 @@ void game_state::add_stock_to_tableau_moves(std::vector<move>& moves) const {
         card from = stock_card_from_count(k_plus_mv.first);
 
         // Obeys the auto-reserve restriction unless the reserve is empty
-        if (!piles[reserve.front()].empty() && tableau_space_and_auto_reserve()) return;
+        if (tableau_space_and_auto_reserve() && !piles[reserve.front()].empty()) return;
 
         for (auto t : tableau_piles) {
             if (is_valid_tableau_move(from, t)) {
@@ -711,7 +716,7 @@ bool game_state::is_next_legal_card(pol p, card a, card b) const {
     return b_rank + 1 == a_rank;
 }
 
-bool game_state::is_next_legal_card(vector<acc_pol> vp, card a, card b) const {
+bool game_state::is_next_legal_card(const vector<acc_pol>& vp, card a, card b) const {
     for (auto p : vp) {
         switch (p) {
             case sol_rules::accordion_policy::SAME_RANK:
@@ -730,11 +735,12 @@ bool game_state::is_next_legal_card(vector<acc_pol> vp, card a, card b) const {
     return false;
 }
 
-void game_state::turn_face_down_cards(vector<move>& moves) const {
-    for (auto& m : moves) {
-        bool is_tableau_move = m.from >= original_tableau_piles.front() && m.from <= original_tableau_piles.back();
-        if (is_tableau_move && piles[m.from].size() > 1 && piles[m.from][1].is_face_down()) {
-            m.make_reveal_move();
+// Only the moves from the given index onwards are checked
+void game_state::turn_face_down_cards(vector<move>& moves, vector<move>::size_type first) const {
+    for (auto m = begin(moves) + first; m != end(moves); m++) {
+        bool is_tableau_move = m->from >= original_tableau_piles.front() && m->from <= original_tableau_piles.back();
+        if (is_tableau_move && piles[m->from].size() > 1 && piles[m->from][1].is_face_down()) {
+            m->make_reveal_move();
         }
     }
 }
@@ -24,10 +24,9 @@
 #include <algorithm>
 #include "game_state.h"
 
-using std::list;
 using std::find;
-using std::rbegin;
-using std::rend;
+using std::begin;
+using std::end;
 
 // Assesses whether the pile ref that was modified was a tableau, cell or
 // reserve pile, and if so makes the relevant function call
@@ -50,39 +49,26 @@ void game_state::eval_pile_order(pile::ref pr, bool is_place) {
     }
 }
 
-// Finds the pile ref in the list and evaluates whether it should be moved to
-// maintain the "pile order"
-void game_state::eval_pile_order(list<pile::ref>& pile_lst, pile::ref changed_pr,
+// Finds the pile ref in the list and moves it along to maintain the "pile
+// order", in the manner of one step of an insertion sort
+void game_state::eval_pile_order(pile_ref_list& pile_lst, pile::ref changed_pr,
                                  bool is_place) {
-    // Finds the first pile that is larger/smaller than the ref pile
-    // (the comp pile).
-    // If the card has been placed, search for the ref from the right hand side
-    // and if not from the lhs
-    if (is_place) {
-        auto changed_ref_iter = find(rbegin(pile_lst), rend(pile_lst), changed_pr);
-        auto comp_iter = changed_ref_iter;
-
-        while (++comp_iter != rend(pile_lst)
-               && piles[*comp_iter] < piles[*changed_ref_iter]);
+    auto i = find(begin(pile_lst), end(pile_lst), changed_pr);
+    assert(i != end(pile_lst));
 
-        if (comp_iter != ++changed_ref_iter) {
-            // Places the ref pile before the comp pile
-            pile_lst.insert(comp_iter.base(), changed_pr);
-            pile_lst.erase(changed_ref_iter.base());
+    // If the card has been placed, the pile can only have grown, so moves it
+    // towards the front past any smaller piles. If not, moves it towards the
+    // back past any larger piles
+    if (is_place) {
+        for (; i != begin(pile_lst) && piles[*(i - 1)] < piles[changed_pr]; i--) {
+            *i = *(i - 1);
         }
     } else {
-        auto changed_ref_iter = find(begin(pile_lst), end(pile_lst), changed_pr);
-        auto comp_iter = changed_ref_iter;
-
-        while (++comp_iter != end(pile_lst)
-               && piles[*comp_iter] > piles[*changed_ref_iter]);
-
-        if (comp_iter != ++changed_ref_iter) {
-            // Places the ref pile before the comp pile
-            pile_lst.insert(comp_iter, changed_pr);
-            pile_lst.erase(--changed_ref_iter);
+        for (; i + 1 != end(pile_lst) && piles[*(i + 1)] > piles[changed_pr]; i++) {
+            *i = *(i + 1);
         }
     }
+    *i = changed_pr;
 
 #ifndef NDEBUG
     // Makes sure the piles are in order
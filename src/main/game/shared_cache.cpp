@@ -0,0 +1,184 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+
+#include "shared_cache.h"
+
+using namespace std;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The shared cache needs lock-free 64 bit atomics");
+
+const shared_cache::thread_id shared_cache::max_threads = 254;
+const uint8_t shared_cache::explored = 255;
+
+static const uint8_t key_block_bits = 14;
+
+// The table is sized so that it is at most 70% full at capacity. Memory from
+// calloc is mapped in lazily, so a large table costs nothing until it is used
+template<class T>
+static T* calloc_array(size_t n) {
+    void* p = calloc(n, sizeof(T));
+    if (!p) throw bad_alloc();
+    return static_cast<T*>(p);
+}
+
+void shared_cache::free_deleter::operator()(void* p) const {
+    free(p);
+}
+
+shared_cache::shared_cache(const game_state& gs, uint64_t max_num_items_)
+        : max_num_items(min(max_num_items_, uint64_t(UINT32_MAX) - 1))
+        , packer(gs)
+        , next_entry(0) {
+    size_type slot_count = 1024;
+    while (max_num_items * 10 > slot_count * 7) slot_count *= 2;
+
+    slots.reset(calloc_array<atomic<uint64_t>>(slot_count));
+    slot_mask = slot_count - 1;
+
+    key_block_count = (max_num_items >> key_block_bits) + 1;
+    key_blocks.reset(new atomic<word*>[key_block_count]());
+    owners.reset(calloc_array<atomic<uint8_t>>(max_num_items + 1));
+}
+
+shared_cache::~shared_cache() {
+    for (size_type i = 0; i < key_block_count; i++) {
+        delete[] key_blocks[i].load();
+    }
+}
+
+pair<shared_cache::handle, bool> shared_cache::insert(const game_state& gs, thread_id tid) {
+    assert(tid < max_threads);
+
+    word k[UINT8_MAX];
+    packer.pack(gs, k);
+    size_t key_bytes = packer.key_words() * sizeof(word);
+
+    uint64_t hash = gs.get_hash();
+    uint64_t hash_high = hash >> 32;
+
+    // The entry is only allocated once an empty slot is found. If another
+    // thread then takes the slot first with the same state, the entry is
+    // left unused
+    bool allocated = false;
+    handle entry = 0;
+
+    for (size_type pos = hash & slot_mask;; pos = (pos + 1) & slot_mask) {
+        uint64_t s = slots[pos].load(memory_order_acquire);
+
+        if (s == 0) {
+            if (!allocated) {
+                uint64_t e = next_entry.fetch_add(1, memory_order_relaxed);
+                if (e >= max_num_items) {
+                    throw runtime_error("Shared cache is full");
+                }
+                entry = static_cast<handle>(e);
+                memcpy(alloc_key(entry), k, key_bytes);
+                owners[entry].store(static_cast<uint8_t>(tid + 1), memory_order_relaxed);
+                allocated = true;
+            }
+
+            uint64_t claimed = hash_high << 32 | (uint64_t(entry) + 1);
+            if (slots[pos].compare_exchange_strong(s, claimed, memory_order_acq_rel)) {
+                return make_pair(entry, true);
+            }
+            // Otherwise s now holds the slot another thread claimed
+        }
+
+        auto other = static_cast<handle>((s & UINT32_MAX) - 1);
+        if (s >> 32 == hash_high && memcmp(key(other), k, key_bytes) == 0) {
+            return make_pair(other, false);
+        }
+    }
+}
+
+bool shared_cache::contains(const game_state& gs) const {
+    word k[UINT8_MAX];
+    packer.pack(gs, k);
+    return slots[find_slot(k, gs.get_hash())].load(memory_order_acquire) != 0;
+}
+
+void shared_cache::set_explored(handle entry) {
+    owners[entry].store(explored, memory_order_release);
+}
+
+shared_cache::status shared_cache::get_status(handle entry) const {
+    return owners[entry].load(memory_order_acquire) == explored
+           ? status::EXPLORED : status::IN_PROGRESS;
+}
+
+shared_cache::thread_id shared_cache::get_owner(handle entry) const {
+    uint8_t owner = owners[entry].load(memory_order_acquire);
+    assert(owner != 0 && owner != explored);
+    return static_cast<thread_id>(owner - 1);
+}
+
+shared_cache::size_type shared_cache::size() const {
+    return min(next_entry.load(memory_order_relaxed), max_num_items);
+}
+
+shared_cache::size_type shared_cache::bucket_count() const {
+    return slot_mask + 1;
+}
+
+// Returns the position of the slot holding the key, or of the first empty
+// slot after it
+shared_cache::size_type shared_cache::find_slot(const word* k, uint64_t hash) const {
+    uint64_t hash_high = hash >> 32;
+    size_t key_bytes = packer.key_words() * sizeof(word);
+
+    for (size_type pos = hash & slot_mask;; pos = (pos + 1) & slot_mask) {
+        uint64_t s = slots[pos].load(memory_order_acquire);
+        if (s == 0) return pos;
+
+        auto entry = static_cast<handle>((s & UINT32_MAX) - 1);
+        if (s >> 32 == hash_high && memcmp(key(entry), k, key_bytes) == 0) {
+            return pos;
+        }
+    }
+}
+
+const shared_cache::word* shared_cache::key(handle entry) const {
+    const word* block = key_blocks[entry >> key_block_bits].load(memory_order_acquire);
+    return block + (entry & ((1 << key_block_bits) - 1)) * packer.key_words();
+}
+
+// Returns the memory for the key of a new entry, allocating its block if this
+// is the first entry in it
+shared_cache::word* shared_cache::alloc_key(handle entry) {
+    atomic<word*>& block = key_blocks[entry >> key_block_bits];
+    word* b = block.load(memory_order_acquire);
+
+    if (!b) {
+        word* fresh = new word[size_t(packer.key_words()) << key_block_bits];
+        if (block.compare_exchange_strong(b, fresh, memory_order_acq_rel)) {
+            b = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+
+    return b + (entry & ((1 << key_block_bits) - 1)) * packer.key_words();
+}
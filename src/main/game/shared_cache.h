@@ -0,0 +1,90 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SOLVITAIRE_SHARED_CACHE_H
+#define SOLVITAIRE_SHARED_CACHE_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+
+#include "global_cache.h"
+#include "search-state/game_state.h"
+
+// A hash table of the states seen by several solver threads working on the
+// same deal. Slots are claimed with a single compare-and-swap, and each entry
+// records which thread is exploring it, or that it has been explored. Entries
+// are never evicted, so the capacity is a hard limit, and the memory for the
+// table is only touched as it fills
+class shared_cache {
+public:
+    typedef uint32_t handle;
+    typedef uint64_t size_type;
+    typedef uint8_t thread_id;
+
+    enum class status { IN_PROGRESS, EXPLORED };
+
+    static const thread_id max_threads;
+
+    explicit shared_cache(const game_state&, uint64_t);
+    ~shared_cache();
+    shared_cache(const shared_cache&) = delete;
+    shared_cache& operator=(const shared_cache&) = delete;
+
+    // Claims a state for a thread. Returns false if the state was already
+    // claimed, by this thread or another. Throws if the cache is full
+    std::pair<handle, bool> insert(const game_state&, thread_id);
+    bool contains(const game_state&) const;
+    void set_explored(handle);
+    status get_status(handle) const;
+    thread_id get_owner(handle) const;
+    size_type size() const;
+    size_type bucket_count() const;
+
+private:
+    typedef key_packer::word word;
+
+    struct free_deleter {
+        void operator()(void*) const;
+    };
+
+    static const uint8_t explored;
+
+    const word* key(handle) const;
+    word* alloc_key(handle);
+    size_type find_slot(const word*, uint64_t) const;
+
+    uint64_t max_num_items;
+    key_packer packer;
+
+    // Each slot is zero when empty, or the upper half of the hash with the
+    // index of the entry (plus one)
+    std::unique_ptr<std::atomic<uint64_t>[], free_deleter> slots;
+    size_type slot_mask;
+
+    // Entries are allocated from a shared counter. Each block of keys is
+    // allocated by whichever thread needs it first
+    std::atomic<uint64_t> next_entry;
+    std::unique_ptr<std::atomic<word*>[]> key_blocks;
+    size_type key_block_count;
+    std::unique_ptr<std::atomic<uint8_t>[], free_deleter> owners;
+};
+
+#endif //SOLVITAIRE_SHARED_CACHE_H
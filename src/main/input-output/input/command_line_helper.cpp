@@ -22,12 +22,14 @@
 //
 
 #include <tuple>
+#include <limits>
 #include <vector>
 
 #include <boost/program_options.hpp>
 
 #include "command_line_helper.h"
 #include "../../game/sol_rules.h"
+#include "../../game/shared_cache.h"
 #include "../output/log_helper.h"
 #include "sol_preset_types.h"
 
@@ -69,18 +71,75 @@ command_line_helper::command_line_helper()
                                                     "Syntax: [sol unsol intract in-progress-1 in-progress-2 ...]")
             ("cores", po::value<uint>(), "the number of cores for the solvability percentages to be run across. "
                                          "Must be supplied with the solvability option.")
+            ("threads", po::value<uint>(), "the number of threads used to solve a single deal, which share a "
+                                           "cache. Applies to 'random' and to lists of deals to be solved. With "
+                                           "'--iddfs', the threads then search several depth limits at once, each "
+                                           "with a share of the cache capacity, so it can't be combined with a "
+                                           "'--iddfs-bounding' other than 'linear'.")
             ("streamliners", po::value<string>(),
                     "Applies streamliners to the search. Options include 'none', 'both', 'suit-symmetry',"
-                    " 'auto-foundations', and 'smart-solvability'. Defaults to 'none', unless '--solvability' is"
+                    " 'auto-foundations', 'smart-solvability' and 'portfolio'. Defaults to 'none', unless '--solvability' is"
                     " also supplied, in which case defaults to 'smart-solvability'. 'smart-solvability' mode"
                     " runs first with both streamliners and a 10% timeout. If this"
-                    " is unsuccessful (unsolvable or timeout), then runs again without streamliners.")
+                    " is unsuccessful (unsolvable or timeout), then runs again without streamliners. 'portfolio'"
+                    " mode runs every combination of streamliners at once, on separate threads, until one finds a"
+                    " solution or the run without streamliners finds the deal unsolvable. Each gets a share of the"
+                    " cache capacity. It can't be combined with '--threads', '--iddfs', '--anytime', '--search',"
+                    " '--restarts', '--history-ordering', '--beam-width' or '--discrepancies'.")
             ("benchmark", "outputs performance statistics for the solver on the "
                           "supplied solitaire game. Must supply "
                           "either 'random', 'benchmark', 'solvability' or list of deals to be "
                           "solved.")
             ("deal-only", "outputs the starting deal for a given game type & random seed as json")
-            ("iddfs", "if true, preform iterative-deeping-DFS, which returns an optimal solution (minimal depth)");
+            ("iddfs", "if true, preform iterative-deeping-DFS, which returns an optimal solution (minimal depth)")
+            ("anytime", "outputs the first solution found straight away, then searches for shorter ones as"
+                        " '--iddfs' does, outputting each as soon as it is found. Stops at the timeout, which covers"
+                        " every search, or once the solution is known to be the shortest")
+            ("history-ordering", "orders the moves tried from each state by how often moves between the same"
+                                 " kinds of pile, with the same card, have led to new states, revealed cards or"
+                                 " been part of a solution so far in the search, in place of the fixed order. It"
+                                 " can't be combined with 'df-pn' or 'best-first' search")
+            ("restarts", po::value<uint64_t>(), "restarts the search after the supplied number of states, then"
+                                                " after that many times each term of the Luby sequence (1, 1, 2, 1, 1,"
+                                                " 2, 4, ...), breaking ties between moves of the same kind at random"
+                                                " after the first run. States searched in full are never searched"
+                                                " again, so the search is still complete. With '--threads', each"
+                                                " thread runs its own search with a different seed and a share of the"
+                                                " cache capacity, and the first to finish wins. Also applies to"
+                                                " '--solvability'.")
+            ("search", po::value<string>(),
+                    "the search used to solve each deal. Options are 'dfs', 'df-pn', 'nrpa' and 'best-first'."
+                    " Defaults to 'dfs'."
+                    " 'df-pn' is depth-first proof-number search, which tries the moves closest to a solution first,"
+                    " by the heuristic's lower bound on the moves left. It can't be combined with '--threads',"
+                    " '--restarts' or '--history-ordering'. 'nrpa' is nested rollout policy adaptation, which plays"
+                    " random moves, learning which lead closest to a solution. It can only find solutions, so once its"
+                    " iterations are spent, the rest of the timeout goes to a DFS, which '--threads' and '--restarts'"
+                    " apply to."
+                    " 'best-first' expands the state which looks closest to a solution first, by the moves to it and"
+                    " an estimate of the moves left, which counts foundation progress, face-down cards and empty"
+                    " tableau piles. Once the cache is full, it starts again as a DFS. It can't be combined with"
+                    " '--threads', '--restarts' or '--history-ordering'.")
+            ("nrpa-level", po::value<uint>(), "the nesting level of 'nrpa' search. Defaults to 2")
+            ("nrpa-iterations", po::value<uint>(), "the number of times each level of 'nrpa' search runs the"
+                                                   " level below it. Defaults to 100")
+            ("beam-width", po::value<uint>(), "only tries the supplied number of moves from each state, the ones"
+                                              " which would be tried first. A solution found is still valid, but if"
+                                              " none is, the deal is reported as inconclusive. With '--solvability',"
+                                              " runs as a pre-pass with a 10% timeout, and only the deals it can't"
+                                              " solve are searched in full. Otherwise, it can't be combined with"
+                                              " '--threads', '--restarts' or 'df-pn' search.")
+            ("discrepancies", po::value<uint>(), "limited discrepancy search: only tries moves other than the first"
+                                                 " from a state the supplied number of times along each path, up to"
+                                                 " 255. Runs and is reported on as '--beam-width' is, and can be"
+                                                 " combined with it.")
+            ("iddfs-bounding", po::value<string>(),
+                    "how the depth bound of '--iddfs' is chosen. Options are 'linear', 'bisect' and 'ida-star'."
+                    " Defaults to 'linear', which lowers the bound by one below each solution found until there is"
+                    " none. 'bisect' halves the gap between the deepest bound without a solution and the shortest"
+                    " solution found, so needs far fewer searches when the first solution is long. 'ida-star'"
+                    " starts from a lower bound on the moves needed and raises the bound by one until a solution"
+                    " is found. Every mode prunes states which can't be solved within the bound.");
 
     po::options_description hidden_options("Hidden options");
     hidden_options.add_options()
@@ -123,7 +182,75 @@ bool command_line_helper::parse(int argc, const char* argv[]) {
 
     deal_only = (vm.count("deal-only") != 0);
     
-    optimal_solution = (vm.count("iddfs") != 0); // if true, after the DFS solution, solve with id-DFS
+    anytime = (vm.count("anytime") != 0);
+
+    history_ordering = (vm.count("history-ordering") != 0);
+
+    if (vm.count("restarts")) {
+        restarts = vm["restarts"].as<uint64_t>();
+    } else {
+        restarts = 0;
+    }
+
+    optimal_solution = (vm.count("iddfs") != 0) || anytime; // if true, after the DFS solution, solve with id-DFS
+
+    if (vm.count("iddfs-bounding")) {
+        auto& b = vm["iddfs-bounding"].as<string>();
+
+        if (b == "linear") bounding = iddfs_bounding::LINEAR;
+        else if (b == "bisect") bounding = iddfs_bounding::BISECT;
+        else if (b == "ida-star") bounding = iddfs_bounding::IDA_STAR;
+        else {
+            print_iddfs_bounding_error(b);
+            return false;
+        }
+    } else {
+        bounding = iddfs_bounding::LINEAR;
+    }
+
+    if (vm.count("search")) {
+        auto& s = vm["search"].as<string>();
+
+        if (s == "dfs") search = search_type::DFS;
+        else if (s == "df-pn") search = search_type::DFPN;
+        else if (s == "nrpa") search = search_type::NRPA;
+        else if (s == "best-first") search = search_type::BEST_FIRST;
+        else {
+            print_search_error(s);
+            return false;
+        }
+    } else {
+        search = search_type::DFS;
+    }
+
+    if (vm.count("nrpa-level")) {
+        nrpa_level = vm["nrpa-level"].as<uint>();
+    } else {
+        nrpa_level = 2;
+    }
+
+    if (vm.count("nrpa-iterations")) {
+        nrpa_iterations = vm["nrpa-iterations"].as<uint>();
+    } else {
+        nrpa_iterations = 100;
+    }
+
+    if (vm.count("beam-width")) {
+        beam_width = vm["beam-width"].as<uint>();
+    } else {
+        beam_width = 0;
+    }
+
+    if (vm.count("discrepancies")) {
+        uint d = vm["discrepancies"].as<uint>();
+        if (d > std::numeric_limits<uint8_t>::max()) {
+            print_search_limits_error();
+            return false;
+        }
+        discrepancies = static_cast<int>(d);
+    } else {
+        discrepancies = -1;
+    }
 
     if (vm.count("input-files")) {
         input_files = vm["input-files"].as<vector<string>>();
@@ -167,6 +294,12 @@ bool command_line_helper::parse(int argc, const char* argv[]) {
         cores = 1;
     }
 
+    if (vm.count("threads")) {
+        threads = vm["threads"].as<uint>();
+    } else {
+        threads = 1;
+    }
+
     if (vm.count("resume")) {
         resume = vm["resume"].as<vector<int>>();
     } else {
@@ -181,6 +314,7 @@ bool command_line_helper::parse(int argc, const char* argv[]) {
         else if (s == "suit-symmetry") streamliners = streamliner_opt::SUIT_SYMMETRY;
         else if (s == "both") streamliners = streamliner_opt::BOTH;
         else if (s == "smart-solvability") streamliners = streamliner_opt::SMART;
+        else if (s == "portfolio") streamliners = streamliner_opt::PORTFOLIO;
         else if (s == "none") streamliners = streamliner_opt::NONE;
         else {
             print_streamliner_error(s);
@@ -212,6 +346,39 @@ bool command_line_helper::assess_errors() {
         return false;
     }
 
+    if (threads == 0 || threads > shared_cache::max_threads) {
+        print_threads_error();
+        return false;
+    }
+
+    // Across several threads, the depth limits are chosen by the parallel search
+    if (threads > 1 && bounding != iddfs_bounding::LINEAR) {
+        print_iddfs_bounding_options_error();
+        return false;
+    }
+
+    bool single_search = search == search_type::DFPN || search == search_type::BEST_FIRST;
+    if (single_search && (threads > 1 || restarts > 0 || history_ordering)) {
+        print_search_options_error();
+        return false;
+    }
+
+    // The limits apply to the pre-pass when calculating solvability, and
+    // otherwise to a single DFS
+    bool limited = beam_width > 0 || discrepancies != -1;
+    if (limited && solvability <= 0 && (threads > 1 || restarts > 0 || search != search_type::DFS)) {
+        print_search_limits_error();
+        return false;
+    }
+
+    // The portfolio runs a plain DFS for each configuration of streamliners
+    bool portfolio_options = threads > 1 || optimal_solution || anytime || search != search_type::DFS
+                             || restarts > 0 || history_ordering || limited;
+    if (streamliners == streamliner_opt::PORTFOLIO && portfolio_options) {
+        print_portfolio_options_error();
+        return false;
+    }
+
     // The user must either supply input files, a random seed, or ask for the
     // solvability percentage, or benchmark
     int opt_count = (random_deal != -1) + !input_files.empty() + (solvability > 0) + benchmark;
@@ -278,9 +445,47 @@ void command_line_helper::print_resume_error() {
     print_help();
 }
 
+void command_line_helper::print_threads_error() {
+    LOG_ERROR ("Error: The number of threads must be between 1 and " << int(shared_cache::max_threads));
+    print_help();
+}
+
 void command_line_helper::print_streamliner_error(const string& str) {
     LOG_ERROR ("Error: invalid streamliner: " + str + ".\nAvailable options are: 'none', 'both', 'suit-symmetry',"
-                                                      " 'auto-foundations', and 'smart-solvability'");
+                                                      " 'auto-foundations', 'smart-solvability' and 'portfolio'");
+}
+
+void command_line_helper::print_iddfs_bounding_error(const string& str) {
+    LOG_ERROR ("Error: invalid iddfs bounding: " + str + ".\nAvailable options are: 'linear', 'bisect' and 'ida-star'");
+}
+
+void command_line_helper::print_iddfs_bounding_options_error() {
+    LOG_ERROR ("Error: '--threads' can only be combined with 'linear' iddfs bounding");
+    print_help();
+}
+
+void command_line_helper::print_search_error(const string& str) {
+    LOG_ERROR ("Error: invalid search: " + str + ".\nAvailable options are: 'dfs', 'df-pn', 'nrpa' and 'best-first'");
+}
+
+void command_line_helper::print_search_options_error() {
+    LOG_ERROR ("Error: 'df-pn' and 'best-first' search can't be combined with '--threads', '--restarts' or "
+               "'--history-ordering'");
+    print_help();
+}
+
+void command_line_helper::print_search_limits_error() {
+    LOG_ERROR ("Error: the number of discrepancies must be at most "
+               << int(std::numeric_limits<uint8_t>::max()) << ", and outside of '--solvability', "
+               "'--beam-width' and '--discrepancies' can't be combined with '--threads', '--restarts' or 'df-pn' "
+               "search");
+    print_help();
+}
+
+void command_line_helper::print_portfolio_options_error() {
+    LOG_ERROR ("Error: the 'portfolio' streamliners can't be combined with '--threads', '--iddfs', '--anytime', "
+               "'--search', '--restarts', '--history-ordering', '--beam-width' or '--discrepancies'");
+    print_help();
 }
 
 const vector<string> command_line_helper::get_input_files() {
@@ -303,6 +508,42 @@ bool command_line_helper::get_optimal_solution() {
     return optimal_solution;
 }
 
+command_line_helper::iddfs_bounding command_line_helper::get_iddfs_bounding() {
+    return bounding;
+}
+
+bool command_line_helper::get_anytime() {
+    return anytime;
+}
+
+bool command_line_helper::get_history_ordering() {
+    return history_ordering;
+}
+
+uint64_t command_line_helper::get_restarts() {
+    return restarts;
+}
+
+command_line_helper::search_type command_line_helper::get_search() {
+    return search;
+}
+
+uint command_line_helper::get_beam_width() {
+    return beam_width;
+}
+
+int command_line_helper::get_discrepancies() {
+    return discrepancies;
+}
+
+uint command_line_helper::get_nrpa_level() {
+    return nrpa_level;
+}
+
+uint command_line_helper::get_nrpa_iterations() {
+    return nrpa_iterations;
+}
+
 bool command_line_helper::get_classify() {
     return classify;
 }
@@ -331,6 +572,10 @@ uint command_line_helper::get_cores() {
     return cores;
 }
 
+uint command_line_helper::get_threads() {
+    return threads;
+}
+
 bool command_line_helper::get_available_game_types() {
     return available_game_types;
 }
@@ -362,6 +607,7 @@ game_state::streamliner_options command_line_helper::convert_streamliners(stream
         case command_line_helper::streamliner_opt::SUIT_SYMMETRY: return game_state::streamliner_options::SUIT_SYMMETRY;
         case command_line_helper::streamliner_opt::BOTH: return game_state::streamliner_options::BOTH;
         case command_line_helper::streamliner_opt::SMART:
+        case command_line_helper::streamliner_opt::PORTFOLIO:
         default:
             assert(false);
             throw runtime_error("attempted to convert smart streamliner mode to single streamliner");
@@ -30,7 +30,9 @@
 class command_line_helper {
 public:
     command_line_helper();
-    enum class streamliner_opt {NONE, AUTO_FOUNDATIONS, SUIT_SYMMETRY, BOTH, SMART};
+    enum class streamliner_opt {NONE, AUTO_FOUNDATIONS, SUIT_SYMMETRY, BOTH, SMART, PORTFOLIO};
+    enum class iddfs_bounding {LINEAR, BISECT, IDA_STAR};
+    enum class search_type {DFS, DFPN, NRPA, BEST_FIRST};
 
     bool parse(int argc, const char* argv[]);
     const std::vector<std::string> get_input_files();
@@ -39,11 +41,21 @@ public:
     int get_random_deal();
 
     bool get_optimal_solution();
+    iddfs_bounding get_iddfs_bounding();
+    bool get_anytime();
+    bool get_history_ordering();
+    uint64_t get_restarts();
+    search_type get_search();
+    uint get_beam_width();
+    int get_discrepancies();
+    uint get_nrpa_level();
+    uint get_nrpa_iterations();
 
     bool get_classify();
     bool get_deal_only();
     int get_solvability();
     uint get_cores();
+    uint get_threads();
     bool get_available_game_types();
     bool get_benchmark();
     streamliner_opt get_streamliners();
@@ -63,7 +75,14 @@ private:
     void print_no_opts_error();
     void print_too_many_opts_error();
     void print_resume_error();
+    void print_threads_error();
     void print_streamliner_error(const std::string&);
+    void print_iddfs_bounding_error(const std::string&);
+    void print_iddfs_bounding_options_error();
+    void print_search_error(const std::string&);
+    void print_search_options_error();
+    void print_search_limits_error();
+    void print_portfolio_options_error();
 
     boost::program_options::options_description cmdline_options;
     boost::program_options::options_description main_options;
@@ -80,6 +99,7 @@ private:
     int solvability;
     std::vector<int> resume;
     uint cores;
+    uint threads;
     bool available_game_types;
     bool version;
     bool benchmark;
@@ -88,6 +108,15 @@ private:
     uint64_t timeout;
     
     bool optimal_solution;
+    iddfs_bounding bounding;
+    bool anytime;
+    bool history_ordering;
+    uint64_t restarts;
+    search_type search;
+    uint beam_width;
+    int discrepancies;
+    uint nrpa_level;
+    uint nrpa_iterations;
 };
 
 #endif //SOLVITAIRE_COMMAND_LINE_HELPER_H
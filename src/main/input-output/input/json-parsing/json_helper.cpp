@@ -98,7 +98,7 @@ void json_helper::print_game_state_as_json(const game_state& gs) {
     write_json (cout, pt);
 }
 
-ptree json_helper::piles_to_ptree(const game_state& gs, const std::list<pile::ref>& piles) {
+ptree json_helper::piles_to_ptree(const game_state& gs, const pile_ref_list& piles) {
     ptree pt;
     for (pile::ref pr : piles) {
         pt.push_back(make_pair("", pile_to_ptree(gs.piles[pr])));
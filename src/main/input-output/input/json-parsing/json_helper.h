@@ -40,7 +40,7 @@ public:
     static const std::string schema_err_str(const rapidjson::SchemaValidator&);
     static void print_game_state_as_json(const game_state&);
 private:
-    static boost::property_tree::ptree piles_to_ptree(const game_state&, const std::list<pile::ref>&);
+    static boost::property_tree::ptree piles_to_ptree(const game_state&, const pile_ref_list&);
     static boost::property_tree::ptree piles_to_ptree(const game_state&, const std::vector<pile::ref>&);
     static boost::property_tree::ptree pile_to_ptree(const pile&);
     static boost::property_tree::ptree card_to_ptree(const card&);
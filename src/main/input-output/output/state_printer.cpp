@@ -25,7 +25,6 @@
 
 using std::ostream;
 using std::vector;
-using std::list;
 
 typedef sol_rules::stock_deal_type sdt;
 
@@ -169,7 +168,7 @@ void state_printer::print_top_of_piles(ostream& stream,
 }
 
 void state_printer::print_accordion(ostream& stream,
-                                       const list<pile::ref>& vp,
+                                       const pile_ref_list& vp,
                                        const game_state& gs) {
     for (pile::ref p : vp) {
         print_card(stream, gs.piles[p].top_card());
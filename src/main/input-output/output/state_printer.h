@@ -46,7 +46,7 @@ private:
                                    const game_state&);
     static void print_top_of_pile(std::ostream&, pile::ref,
                                   const game_state&);
-    static void print_accordion(std::ostream&, const std::list<pile::ref>&,
+    static void print_accordion(std::ostream&, const pile_ref_list&,
                                   const game_state&);
     static void print_card(std::ostream&, card);
 };
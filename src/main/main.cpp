@@ -17,9 +17,10 @@
   with this program (see LICENSE file); if not, write to the Free Software
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
+#include <functional>
+
 #include <boost/program_options.hpp>
 #include <boost/optional.hpp>
-#include "boost/tuple/tuple.hpp"
 
 #include "version.h"
 #include "../../lib/rapidjson/document.h"
@@ -29,6 +30,10 @@
 #include "input-output/input/json-parsing/rules_parser.h"
 #include "input-output/output/log_helper.h"
 #include "solver/solver.h"
+#include "solver/parallel_solver.h"
+#include "solver/portfolio_solver.h"
+#include "solver/parallel_iddfs.h"
+#include "solver/restart_portfolio.h"
 #include "evaluation/solvability_calc.h"
 #include "evaluation/benchmark.h"
 
@@ -45,12 +50,21 @@ const optional<sol_rules> gen_rules(command_line_helper &);
 void solve_random_game(int, const sol_rules &, command_line_helper &);
 void solve_input_files(vector<string>, const sol_rules &, command_line_helper &);
 void solve_game(const sol_rules &rules, command_line_helper &clh, optional<int> seed, optional<const Document &> in_doc);
-pair<solver, solver::result> solve_game(const sol_rules &rules, uint64_t timeout, uint64_t cache_capacity,
-                                        game_state::streamliner_options str_opts,
-                                        optional<int> seed, optional<const Document &> in_doc, bool iddfs);
-boost::tuple<solver, solver::result, bool> run_iddfs(uint64_t optimal_depth, const sol_rules &rules, uint64_t timeout, uint64_t cache_capacity,
-                                       game_state::streamliner_options str_opts,
-                                       optional<int> seed, optional<const Document &> in_doc);
+void solve_game_portfolio(const sol_rules &rules, command_line_helper &clh, optional<int> seed, optional<const Document &> in_doc);
+solver::outcome solve_game(const sol_rules &rules, uint64_t timeout, uint64_t cache_capacity,
+                           game_state::streamliner_options str_opts,
+                           optional<int> seed, optional<const Document &> in_doc,
+                           optional<command_line_helper::iddfs_bounding> iddfs, bool anytime, uint threads,
+                           bool history_ordering, uint64_t restarts, command_line_helper::search_type search,
+                           solver::search_limits limits, uint nrpa_level, uint nrpa_iterations);
+solver::outcome run_dfs(const game_state &gs, uint64_t timeout, uint64_t cache_capacity, uint threads,
+                        bool history_ordering, uint64_t restarts, command_line_helper::search_type search,
+                        solver::search_limits limits, uint nrpa_level, uint nrpa_iterations);
+solver::search_limits get_search_limits(command_line_helper &);
+optional<solver::outcome> run_iddfs(uint64_t optimal_depth, const game_state &gs, uint64_t timeout, uint64_t cache_capacity,
+                                    command_line_helper::iddfs_bounding, uint threads, bool history_ordering,
+                                    optional<std::chrono::steady_clock::time_point> deadline,
+                                    const std::function<void(const solver::outcome &)> &on_solution);
 void print_version();
 
 // Decides what to do given supplied command-line options
@@ -95,7 +109,9 @@ int main(int argc, const char* argv[]) {
     if (clh.get_solvability() > 0) {
         solvability_calc solv_c(*rules, clh.get_cache_capacity());
         solv_c.calculate_solvability_percentage(clh.get_timeout(), clh.get_solvability(), clh.get_cores(),
-                                                clh.get_streamliners(), clh.get_resume());
+                                                clh.get_streamliners(), clh.get_resume(), clh.get_restarts(),
+                                                clh.get_search(), get_search_limits(clh), clh.get_nrpa_level(),
+                                                clh.get_nrpa_iterations());
     }
     // If a random deal seed has been supplied, solves it
     else if (clh.get_random_deal() != -1) {
@@ -138,6 +154,13 @@ const optional<sol_rules> gen_rules(command_line_helper& clh) {
     }
 }
 
+// The limits on the moves tried from each state, if any were supplied
+solver::search_limits get_search_limits(command_line_helper& clh) {
+    solver::search_limits limits{clh.get_beam_width(), none};
+    if (clh.get_discrepancies() != -1) limits.discrepancies = static_cast<uint8_t>(clh.get_discrepancies());
+    return limits;
+}
+
 void solve_random_game(int seed, const sol_rules& rules, command_line_helper& clh) {
     if (!clh.get_classify())
         LOG_INFO ("Attempting to solve with seed: " << seed << "...");
@@ -162,7 +185,10 @@ void solve_input_files(const vector<string> input_files, const sol_rules& rules,
 }
 
 void solve_game(const sol_rules& rules, command_line_helper& clh, optional<int> seed, optional<const Document&> in_doc) {
-    typedef pair<solver, solver::result> solve_sol;
+    if (clh.get_streamliners() == command_line_helper::streamliner_opt::PORTFOLIO) {
+        solve_game_portfolio(rules, clh, seed, in_doc);
+        return;
+    }
 
     bool smart = clh.get_streamliners() == command_line_helper::streamliner_opt::SMART;
 
@@ -175,114 +201,272 @@ void solve_game(const sol_rules& rules, command_line_helper& clh, optional<int>
         timeout = clh.get_timeout();
         str_opt = clh.get_streamliners_game_state();
     }
-    solve_sol solution = solve_game(rules, timeout, clh.get_cache_capacity(), str_opt, seed, in_doc, clh.get_optimal_solution());
-
-    bool run_again = smart && solution.second.sol_type != solver::result::type::SOLVED;
+    optional<command_line_helper::iddfs_bounding> iddfs = clh.get_optimal_solution()
+            ? optional<command_line_helper::iddfs_bounding>(clh.get_iddfs_bounding())
+            : none;
+    // Solutions are output as they are found, unless only a classification is wanted
+    bool anytime = clh.get_anytime() && !clh.get_classify();
+    solver::outcome solution = solve_game(rules, timeout, clh.get_cache_capacity(), str_opt, seed, in_doc,
+                                          iddfs, anytime, clh.get_threads(), clh.get_history_ordering(),
+                                          clh.get_restarts(), clh.get_search(), get_search_limits(clh),
+                                          clh.get_nrpa_level(), clh.get_nrpa_iterations());
+
+    bool run_again = smart && solution.res.sol_type != solver::result::type::SOLVED;
     cout.flush();
     if (run_again)
         if (!clh.get_classify()) cout << "Unsolvable using streamliner. Running again...\n";
-    optional<solve_sol> streamliner_solution = run_again
-            ? solve_game(rules, clh.get_timeout(), clh.get_cache_capacity(), game_state::streamliner_options::NONE, seed, in_doc, clh.get_optimal_solution())
-            : optional<solve_sol>();
+    optional<solver::outcome> streamliner_solution = run_again
+            ? optional<solver::outcome>(solve_game(rules, clh.get_timeout(), clh.get_cache_capacity(),
+                                                   game_state::streamliner_options::NONE, seed, in_doc,
+                                                   iddfs, anytime, clh.get_threads(),
+                                                   clh.get_history_ordering(), clh.get_restarts(),
+                                                   clh.get_search(), get_search_limits(clh),
+                                                   clh.get_nrpa_level(), clh.get_nrpa_iterations()))
+            : optional<solver::outcome>();
 
     if (clh.get_classify()) {
         if (seed) cout << *seed;
-        solver::print_result_csv(solution.second);
+        solver::print_result_csv(solution.res);
         if (smart) {
             if (run_again) {
-                solver::print_result_csv(streamliner_solution->second);
-                cout << ", " << streamliner_solution->second.sol_type;
+                solver::print_result_csv(streamliner_solution->res);
+                cout << ", " << streamliner_solution->res.sol_type;
             } else {
                 solver::print_null_seed_info();
-                cout << ", " << solution.second.sol_type;
+                cout << ", " << solution.res.sol_type;
             }
         } else {
-            cout << ", " << solution.second.sol_type;
+            cout << ", " << solution.res.sol_type;
         }
         cout << "\n";
     } else {
-        pair<solver, solver::result> s = run_again ? *streamliner_solution : solution;
+        const solver::outcome& s = run_again ? *streamliner_solution : solution;
+
+        // In anytime mode, the solution has been output already
+        if (s.res.sol_type == solver::result::type::SOLVED) {
+            if (!anytime) s.print_solution();
+        } else {
+            cout << "Deal:\n" << s.init_state << "\n";
+        }
+        cout << "\n"<<s.res;
+    }
+    cout.flush();
+}
+
+// Races the streamliner configurations against each other, and outputs the
+// results in the same layout as the smart streamliner mode
+void solve_game_portfolio(const sol_rules& rules, command_line_helper& clh, optional<int> seed, optional<const Document&> in_doc) {
+    portfolio_solver ps(rules, seed, in_doc, clh.get_cache_capacity());
+    ps.run(std::chrono::milliseconds(clh.get_timeout()));
 
-        if (s.second.sol_type == solver::result::type::SOLVED) {
-            s.first.print_solution();
+    const solver::result& stream_res = ps.get_streamliner_result();
+    optional<solver::result> no_stream_res = ps.get_non_streamliner_result();
+    const solver::result& res = no_stream_res ? *no_stream_res : stream_res;
+
+    if (clh.get_classify()) {
+        if (seed) cout << *seed;
+        solver::print_result_csv(stream_res);
+        if (no_stream_res) solver::print_result_csv(*no_stream_res);
+        else solver::print_null_seed_info();
+        cout << ", " << res.sol_type << "\n";
+    } else {
+        if (res.sol_type == solver::result::type::SOLVED) {
+            ps.get_solver().print_solution();
         } else {
-            cout << "Deal:\n" << s.first.init_state << "\n";
+            cout << "Deal:\n" << ps.get_solver().init_state << "\n";
         }
-        cout << "\n"<<s.second;
+        cout << "\n" << res;
     }
     cout.flush();
 }
 
-pair<solver, solver::result> solve_game(const sol_rules& rules, uint64_t timeout, uint64_t cache_capacity,
-                                        game_state::streamliner_options str_opts,
-                                        optional<int> seed, optional<const Document&> in_doc,
-                                        bool iddfs) {
+// In anytime mode, each solution is output as soon as it is found, starting with
+// the DFS one, and the searches for shorter ones share what is left of the timeout
+solver::outcome solve_game(const sol_rules& rules, uint64_t timeout, uint64_t cache_capacity,
+                           game_state::streamliner_options str_opts,
+                           optional<int> seed, optional<const Document&> in_doc,
+                           optional<command_line_helper::iddfs_bounding> iddfs, bool anytime, uint threads,
+                           bool history_ordering, uint64_t restarts, command_line_helper::search_type search,
+                           solver::search_limits limits, uint nrpa_level, uint nrpa_iterations) {
+    const auto deadline = std::chrono::steady_clock::now() + millisec(timeout);
+
     // DFS (non-optimal solution, used as an starting maximal depth for the)
     cout << "DFS:\n";
     game_state gs = seed ? game_state(rules, *seed, str_opts) : game_state(rules, *in_doc, str_opts);
-    solver sol(gs, cache_capacity);
-    solver::result res = sol.run(std::chrono::milliseconds(timeout));
+    solver::outcome dfs_solution = run_dfs(gs, timeout, cache_capacity, threads, history_ordering, restarts,
+                                           search, limits, nrpa_level, nrpa_iterations);
+    const solver::result& res = dfs_solution.res;
     cout << res;
     std::flush(cout);
     if (res.sol_type != solver::result::type::SOLVED || !iddfs) {
-        // if no DFS solution or iddfs arg is false, dont go into idDFS
-        return make_pair(sol, res);
+        // if no DFS solution or iddfs arg is not supplied, dont go into idDFS
+        if (anytime && res.sol_type == solver::result::type::SOLVED) dfs_solution.print_solution();
+        return dfs_solution;
     }
-        
-    // idDFS (starts at the DFS solution-1 and decreses the depth until the first unsolvable)
+
+    std::function<void(const solver::outcome&)> on_solution;
+    if (anytime) {
+        on_solution = [](const solver::outcome& o) {
+            cout << "Found a solution of " << o.moves.size() << " moves\n";
+            o.print_solution();
+            cout.flush();
+        };
+        on_solution(dfs_solution);
+    }
+
+    // idDFS (bounds the depth between the DFS solution and the deepest depth without one)
     cout << "ID-DFS:\n";
-    boost::tuple<solver, solver::result, bool> iddfs_solver_result_flag = run_iddfs(res.depth, rules, timeout, cache_capacity, str_opts, seed, in_doc);
-    if (get<2>(iddfs_solver_result_flag)) {
-        return make_pair(get<0>(iddfs_solver_result_flag), get<1>(iddfs_solver_result_flag));
+    optional<solver::outcome> iddfs_solution = run_iddfs(res.depth, gs, timeout, cache_capacity, *iddfs, threads,
+                                                         history_ordering,
+                                                         anytime ? optional<std::chrono::steady_clock::time_point>(deadline) : none,
+                                                         on_solution);
+    if (iddfs_solution) {
+        return std::move(*iddfs_solution);
     }
     cout << "ID-DFS did not find a solution\n";
-    return make_pair(sol, res);
+    return dfs_solution;
 }
 
+// Runs a depth-first search, across several threads if requested, and with
+// restarts after the given number of states, unless it is 0. Rollouts come
+// first when requested. Proof-number search, best-first search and searches
+// with limits run on their own. Only the outcome is returned, so the solvers
+// and their caches are freed on return
+solver::outcome run_dfs(const game_state &gs, uint64_t timeout, uint64_t cache_capacity, uint threads,
+                        bool history_ordering, uint64_t restarts, command_line_helper::search_type search,
+                        solver::search_limits limits, uint nrpa_level, uint nrpa_iterations) {
+    if (search == command_line_helper::search_type::DFPN) {
+        solver sol(gs, cache_capacity);
+        sol.run_DFPN(std::chrono::milliseconds(timeout));
+        return sol.get_outcome();
+    }
+    if (search == command_line_helper::search_type::BEST_FIRST) {
+        solver sol(gs, cache_capacity);
+        sol.run_best_first(std::chrono::milliseconds(timeout));
+        return sol.get_outcome();
+    }
+    if (search == command_line_helper::search_type::NRPA) {
+        // Rollouts can only find a solution, so once their iterations are
+        // spent, the rest of the timeout goes to a DFS
+        solver::result rollouts;
+        {
+            solver sol(gs, cache_capacity);
+            rollouts = sol.run_NRPA(nrpa_level, nrpa_iterations, std::chrono::milliseconds(timeout));
+            if (rollouts.sol_type != solver::result::type::INCONCLUSIVE) return sol.get_outcome();
+        }
+
+        const uint64_t spent = std::min(timeout, uint64_t(rollouts.time.count()));
+        solver::outcome full = run_dfs(gs, timeout - spent, cache_capacity, threads, history_ordering, restarts,
+                                       command_line_helper::search_type::DFS, limits, nrpa_level, nrpa_iterations);
+        full.res.states_searched += rollouts.states_searched;
+        full.res.unique_states_searched += rollouts.unique_states_searched;
+        full.res.time += rollouts.time;
+        return full;
+    }
+
+    if (restarts > 0 && threads > 1) {
+        restart_portfolio rp(gs, cache_capacity, threads, restarts);
+        if (history_ordering) rp.enable_history_ordering();
+        rp.run(std::chrono::milliseconds(timeout));
+        return rp.get_solver().get_outcome();
+    }
+    if (threads > 1) {
+        parallel_solver ps(gs, cache_capacity, threads);
+        if (history_ordering) ps.enable_history_ordering();
+        ps.run(std::chrono::milliseconds(timeout));
+        return ps.get_solver().get_outcome();
+    }
 
-boost::tuple<solver, solver::result, bool> run_iddfs(uint64_t optimal_depth, const sol_rules &rules, uint64_t timeout, uint64_t cache_capacity,
-                                       game_state::streamliner_options str_opts,
-                                       optional<int> seed, optional<const Document &> in_doc)
+    solver sol(gs, cache_capacity);
+    if (history_ordering) sol.enable_history_ordering();
+    sol.set_search_limits(limits);
+    if (restarts > 0) sol.run_restarts(restarts, 0, std::chrono::milliseconds(timeout));
+    else sol.run(std::chrono::milliseconds(timeout));
+    return sol.get_outcome();
+}
+
+// Returns the shortest solution found, if any is shorter than the supplied depth.
+// Each depth-limited search either tightens the upper bound to the length of
+// the solution it finds, or raises the lower bound to its depth. The linear
+// bounding searches just below the shortest solution each time, the bisecting
+// one halfway between the bounds, and IDA* just above the lower bound, so that
+// the first solution it finds is the shortest. Each search stops at the timeout,
+// or at the deadline if there is one. The function, if any, is called with each
+// shorter solution as soon as it is found
+optional<solver::outcome> run_iddfs(uint64_t optimal_depth, const game_state &gs, uint64_t timeout, uint64_t cache_capacity,
+                                    command_line_helper::iddfs_bounding bounding, uint threads, bool history_ordering,
+                                    optional<std::chrono::steady_clock::time_point> deadline,
+                                    const std::function<void(const solver::outcome &)> &on_solution)
 {
-    game_state gs2 = seed ? game_state(rules, *seed, str_opts) : game_state(rules, *in_doc, str_opts);
-    solver sol_iddfs_optimal_depth(gs2, cache_capacity);
-    solver::result res_iddfs_optimal_depth;
+    // Across several threads, the depths are chosen by the parallel search
+    if (threads > 1) {
+        parallel_iddfs pi(gs, optimal_depth, cache_capacity, threads);
+        if (on_solution) pi.set_solution_callback(on_solution);
+        if (deadline) pi.set_deadline(*deadline);
+        if (history_ordering) pi.enable_history_ordering();
+        pi.run(millisec(timeout));
+
+        if (pi.proved_optimal()) cout << "ID-DFS - shortest solution found\n";
+        return pi.take_solution();
+    }
+
+    optional<solver::outcome> best_solution;
+
+    // The same solver is used for every depth, so that states already searched
+    // without a solution are skipped unless reached with more depth left, and
+    // move ordering carries what it learns from one depth to the next
+    solver current_solver(gs, cache_capacity);
+    if (history_ordering) current_solver.enable_history_ordering();
 
-    bool iddfs_found_better_solution = false;
-    for (uint64_t depth = optimal_depth - 1; depth > 0; --depth)
+    // No solution is shorter than the heuristic's lower bound for the initial
+    // state, which isn't solved, as the DFS had to find a solution
+    uint64_t unsolvable_depth = std::max(gs.min_moves_to_solve(), uint32_t(1)) - 1;
+
+    while (optimal_depth - unsolvable_depth > 1)
     {
-        if (depth >= optimal_depth)
-        {
-            // already found a solution at this depth.
-            cout << "ID-DFS - depth: " << depth << " skipped, previous solution is shorter\n";
-            continue;
+        uint64_t depth = optimal_depth - 1;
+        switch (bounding) {
+            case command_line_helper::iddfs_bounding::LINEAR:
+                break;
+            case command_line_helper::iddfs_bounding::BISECT:
+                depth = unsolvable_depth + (optimal_depth - unsolvable_depth) / 2;
+                break;
+            case command_line_helper::iddfs_bounding::IDA_STAR:
+                depth = unsolvable_depth + 1;
+                break;
+        }
+
+        millisec search_timeout(timeout);
+        if (deadline) {
+            millisec time_left = std::chrono::duration_cast<millisec>(*deadline - std::chrono::steady_clock::now());
+            if (time_left.count() <= 0) break;
+            search_timeout = std::min(search_timeout, time_left);
         }
 
         cout << "ID-DFS - explore solution up to depth: " << depth;
 
-        game_state gs2 = seed ? game_state(rules, *seed, str_opts) : game_state(rules, *in_doc, str_opts);
-        solver current_solver(gs2, cache_capacity);
-        solver::result current_result = current_solver.run_DLS(depth, std::chrono::milliseconds(timeout));
+        solver::result current_result = current_solver.run_DLS(depth, search_timeout);
 
         cout << " -> at depth " << current_result.depth << " " << current_result.sol_type << "\n";
 
-        if (current_result.sol_type != solver::result::type::SOLVED)
-        { //type = {TIMEOUT, UNSOLVABLE, MEM_LIMIT, TERMINATED}
-            if (iddfs_found_better_solution) {
-                return boost::make_tuple(sol_iddfs_optimal_depth, res_iddfs_optimal_depth, true);
-            }
-            return boost::make_tuple(current_solver, current_result, false); //TODO: TODO: return tuple with a bool false that represent no solution was found.
-        }
-        else
+        if (current_result.sol_type == solver::result::type::SOLVED)
         {
-            iddfs_found_better_solution = true;
             optimal_depth = current_result.depth; // update the depth limit.
 
-            // pointer to the solution. return that solution if depth-1 will not be solved.
-            solver sol_iddfs_optimal_depth = current_solver;
-            res_iddfs_optimal_depth = current_result;
+            // keeps the solution, to be returned if no shorter one is found.
+            best_solution.emplace(current_solver.get_outcome());
+            if (on_solution) on_solution(*best_solution);
+        }
+        else if (current_result.sol_type == solver::result::type::UNSOLVABLE)
+        {
+            unsolvable_depth = depth;
+        }
+        else
+        { //type = {TIMEOUT, MEM_LIMIT, TERMINATED}
+            break;
         }
     }
 
-    return boost::make_tuple(sol_iddfs_optimal_depth, res_iddfs_optimal_depth, false); // returns tuple with a bool false that represent no solution was found.
+    if (optimal_depth - unsolvable_depth <= 1) cout << "ID-DFS - shortest solution found\n";
+    return best_solution;
 }
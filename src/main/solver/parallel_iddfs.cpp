@@ -0,0 +1,170 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <thread>
+#include <iostream>
+#include <algorithm>
+
+#include "parallel_iddfs.h"
+
+using std::vector;
+using std::thread;
+using std::mutex;
+using std::unique_lock;
+using std::cout;
+using boost::optional;
+
+typedef solver::result::type sol_type;
+
+// Each thread has a share of the cache capacity
+parallel_iddfs::parallel_iddfs(const game_state& gs, uint64_t optimal_depth_, uint64_t cache_capacity,
+                               unsigned thread_count)
+        : optimal_depth(optimal_depth_)
+        // No solution is shorter than the heuristic's lower bound for the
+        // initial state, which isn't solved, as a solution was supplied
+        , unsolvable_depth(std::max(gs.min_moves_to_solve(), uint32_t(1)) - 1)
+        , stop(false)
+        , best_solution() {
+    assert(thread_count > 0);
+
+    for (unsigned i = 0; i < thread_count; i++) {
+        workers.emplace_back(new worker(gs, cache_capacity / thread_count));
+    }
+}
+
+parallel_iddfs::worker::worker(const game_state& gs, uint64_t cache_capacity)
+        : sol(gs, cache_capacity)
+        , cancel(false)
+        , depth() {
+    sol.set_cancel_flag(cancel);
+}
+
+void parallel_iddfs::set_solution_callback(std::function<void(const solver::outcome&)> f) {
+    on_solution = std::move(f);
+}
+
+void parallel_iddfs::set_deadline(std::chrono::steady_clock::time_point t) {
+    deadline = t;
+}
+
+void parallel_iddfs::enable_history_ordering() {
+    for (auto& w : workers) w->sol.enable_history_ordering();
+}
+
+void parallel_iddfs::run(optional<std::chrono::milliseconds> timeout) {
+    vector<thread> threads;
+    for (auto& w : workers) {
+        threads.emplace_back(&parallel_iddfs::search, this, std::ref(*w), timeout);
+    }
+    for (thread& t : threads) t.join();
+}
+
+optional<solver::outcome> parallel_iddfs::take_solution() {
+    return std::move(best_solution);
+}
+
+bool parallel_iddfs::proved_optimal() const {
+    return optimal_depth - unsolvable_depth <= 1;
+}
+
+// Each thread takes the deepest limit nobody is searching, and runs its solver
+// to it. The solver's cache is kept from one limit to the next
+void parallel_iddfs::search(worker& w, optional<std::chrono::milliseconds> timeout) {
+    unique_lock<mutex> lock(depth_mutex);
+
+    while (!finished()) {
+        optional<uint64_t> depth = next_depth();
+        if (!depth) {
+            // Every limit worth searching is being searched already
+            depth_cond.wait(lock);
+            continue;
+        }
+
+        optional<std::chrono::milliseconds> search_timeout = timeout;
+        if (deadline) {
+            auto time_left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    *deadline - std::chrono::steady_clock::now());
+            if (time_left.count() <= 0) {
+                stop = true;
+                cancel_redundant();
+                depth_cond.notify_all();
+                break;
+            }
+            search_timeout = timeout ? std::min(*timeout, time_left) : time_left;
+        }
+
+        w.depth = depth;
+        w.cancel = false;
+        lock.unlock();
+
+        solver::result res = w.sol.run_DLS(*depth, search_timeout);
+
+        lock.lock();
+        w.depth = boost::none;
+
+        cout << "ID-DFS - explore solution up to depth: " << *depth
+             << " -> at depth " << res.depth << " " << res.sol_type << "\n";
+
+        if (res.sol_type == sol_type::SOLVED) {
+            if (res.depth < optimal_depth) {
+                optimal_depth = res.depth;
+                best_solution.emplace(w.sol.get_outcome());
+                if (on_solution) on_solution(*best_solution);
+            }
+        } else if (res.sol_type == sol_type::UNSOLVABLE) {
+            unsolvable_depth = std::max(*depth, unsolvable_depth);
+        } else if (res.sol_type != sol_type::TERMINATED || !w.cancel) {
+            // Timed out, ran out of memory or was interrupted
+            stop = true;
+        }
+
+        cancel_redundant();
+        depth_cond.notify_all();
+    }
+}
+
+// The limits one, two, four and so on below the shortest solution, which are
+// still above the deepest limit without one
+optional<uint64_t> parallel_iddfs::next_depth() const {
+    for (uint64_t gap = 1; gap < optimal_depth - unsolvable_depth; gap *= 2) {
+        uint64_t depth = optimal_depth - gap;
+
+        bool taken = std::any_of(begin(workers), end(workers), [depth](const std::unique_ptr<worker>& w) {
+            return w->depth == depth;
+        });
+        if (!taken) return depth;
+    }
+    return boost::none;
+}
+
+// Cancels the searches which can no longer tighten the bounds
+void parallel_iddfs::cancel_redundant() {
+    for (auto& w : workers) {
+        if (!w->depth) continue;
+
+        if (stop || *w->depth >= optimal_depth || *w->depth <= unsolvable_depth) {
+            w->cancel = true;
+        }
+    }
+}
+
+bool parallel_iddfs::finished() const {
+    return stop || proved_optimal();
+}
@@ -0,0 +1,86 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SOLVITAIRE_PARALLEL_IDDFS_H
+#define SOLVITAIRE_PARALLEL_IDDFS_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+
+#include <boost/optional.hpp>
+
+#include "solver.h"
+
+// Searches several depth limits for a shorter solution at once, one on each
+// thread, each thread with a solver of its own. Given the length L of the
+// shortest solution known, the limits L-1, L-2, L-4 and so on are searched. A
+// solution cancels the searches whose limits are no shorter than it, and a
+// limit shown to have no solution cancels the searches below it
+class parallel_iddfs {
+public:
+    parallel_iddfs(const game_state&, uint64_t, uint64_t, unsigned);
+
+    // Calls the function with each shorter solution as soon as it is found
+    void set_solution_callback(std::function<void(const solver::outcome&)>);
+    // Stops all searches at the given time, as well as each one at its timeout
+    void set_deadline(std::chrono::steady_clock::time_point);
+    // Each thread orders its moves by the history of its own searches
+    void enable_history_ordering();
+
+    void run(boost::optional<std::chrono::milliseconds> = boost::none);
+
+    // The shortest solution found, if any was shorter than the supplied length
+    boost::optional<solver::outcome> take_solution();
+    // Whether every depth below that of the shortest solution has none
+    bool proved_optimal() const;
+
+private:
+    struct worker {
+        worker(const game_state&, uint64_t);
+
+        solver sol;
+        std::atomic<bool> cancel;
+        boost::optional<uint64_t> depth;
+    };
+
+    void search(worker&, boost::optional<std::chrono::milliseconds>);
+    boost::optional<uint64_t> next_depth() const;
+    void cancel_redundant();
+    bool finished() const;
+
+    std::vector<std::unique_ptr<worker>> workers;
+
+    std::mutex depth_mutex;
+    std::condition_variable depth_cond;
+    uint64_t optimal_depth;
+    uint64_t unsolvable_depth;
+    bool stop;
+
+    boost::optional<solver::outcome> best_solution;
+    std::function<void(const solver::outcome&)> on_solution;
+    boost::optional<std::chrono::steady_clock::time_point> deadline;
+};
+
+#endif //SOLVITAIRE_PARALLEL_IDDFS_H
@@ -0,0 +1,169 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <thread>
+#include <signal.h>
+
+#include "parallel_solver.h"
+
+using std::vector;
+using std::thread;
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+using std::max;
+using boost::optional;
+
+typedef solver::result::type sol_type;
+
+parallel_solver::parallel_solver(const game_state& gs, uint64_t cache_capacity, unsigned thread_count)
+        : cache(gs, cache_capacity)
+        , idle(0)
+        , wanted(0)
+        , stop(false)
+        , outcome(sol_type::UNSOLVABLE)
+        , winner(0) {
+    assert(thread_count > 0 && thread_count <= shared_cache::max_threads);
+
+    for (unsigned t = 0; t < thread_count; t++) {
+        solvers.emplace_back(new solver(gs, *this, static_cast<shared_cache::thread_id>(t)));
+    }
+}
+
+void parallel_solver::enable_history_ordering() {
+    for (auto& s : solvers) s->enable_history_ordering();
+}
+
+solver::result parallel_solver::run(optional<std::chrono::milliseconds> timeout) {
+    signal(SIGINT, sigint_handler);
+
+    const clock::time_point start_time = clock::now();
+    const optional<clock::time_point> end_time =
+            boost::make_optional(bool(timeout), start_time + timeout.value_or(std::chrono::milliseconds(0)));
+
+    vector<thread> threads;
+    for (shared_cache::thread_id t = 0; t < solvers.size(); t++) {
+        threads.emplace_back(&parallel_solver::search, this, t, end_time);
+    }
+    for (thread& t : threads) t.join();
+
+    // Merges the results of the threads, taking the depths from the solver
+    // which found the solution
+    solver::result res = solvers[winner]->res;
+    res.sol_type = outcome;
+    res.states_searched = res.unique_states_searched = res.backtracks = res.dominance_moves = 0;
+    for (auto& s : solvers) {
+        res.states_searched        += s->res.states_searched;
+        res.unique_states_searched += s->res.unique_states_searched;
+        res.backtracks             += s->res.backtracks;
+        res.dominance_moves        += s->res.dominance_moves;
+        res.max_depth = max(res.max_depth, s->res.max_depth);
+    }
+    res.states_removed_from_cache = 0;
+    res.cache_size = cache.size();
+    res.cache_bucket_count = cache.bucket_count();
+    res.time = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start_time);
+
+    solvers[winner]->res = res;
+    return res;
+}
+
+const solver& parallel_solver::get_solver() const {
+    return *solvers[winner];
+}
+
+// The loop run by each thread. The first thread starts at the root, and the
+// others wait to be given work
+void parallel_solver::search(shared_cache::thread_id t, optional<clock::time_point> end_time) {
+    solver& sol = *solvers[t];
+
+    for (bool has_work = t == 0;; has_work = false) {
+        if (!has_work) {
+            optional<vector<move>> prefix = take_work();
+            if (!prefix) return;
+            sol.start_from(*prefix);
+        }
+
+        sol_type res = sol.dfs(end_time).sol_type;
+
+        // Running out of states only means that this thread's part of the
+        // search is done
+        if (res != sol_type::UNSOLVABLE) {
+            finish(res, t);
+            return;
+        }
+    }
+}
+
+// Waits for another thread to give this one some work. Returns nothing when
+// the search is over, which is when all threads are waiting for work
+optional<vector<move>> parallel_solver::take_work() {
+    unique_lock<mutex> lock(work_mutex);
+    idle++;
+
+    while (work.empty() && !stop) {
+        if (idle == solvers.size()) {
+            stop = true;
+            work_cond.notify_all();
+            break;
+        }
+        wanted = int(idle) - int(work.size());
+        work_cond.wait(lock);
+    }
+
+    if (stop) return boost::none;
+
+    vector<move> prefix = std::move(work.front());
+    work.pop_front();
+    idle--;
+    wanted = int(idle) - int(work.size());
+    return prefix;
+}
+
+// Returns false if the work is no longer wanted
+bool parallel_solver::give_work(const vector<move>& prefix) {
+    lock_guard<mutex> lock(work_mutex);
+    if (stop || work.size() >= idle) return false;
+
+    work.push_back(prefix);
+    wanted = int(idle) - int(work.size());
+    work_cond.notify_one();
+    return true;
+}
+
+// Ends the search for all threads. Only the first outcome is kept, as the
+// others are the threads being stopped
+void parallel_solver::finish(sol_type res, shared_cache::thread_id t) {
+    lock_guard<mutex> lock(work_mutex);
+    if (!stop) {
+        outcome = res;
+        winner = t;
+        stop = true;
+    }
+    work_cond.notify_all();
+}
+
+bool parallel_solver::work_wanted() const {
+    return wanted.load(std::memory_order_relaxed) > 0;
+}
+
+bool parallel_solver::stopped() const {
+    return stop.load(std::memory_order_relaxed);
+}
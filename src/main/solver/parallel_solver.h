@@ -0,0 +1,78 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SOLVITAIRE_PARALLEL_SOLVER_H
+#define SOLVITAIRE_PARALLEL_SOLVER_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+#include <boost/optional.hpp>
+
+#include "solver.h"
+#include "../game/shared_cache.h"
+
+// Solves a single deal with several threads, each running its own depth-first
+// search and sharing a cache. One thread starts at the root. When a thread runs
+// out of work, a busy thread gives it an untried move from the shallowest open
+// node of its search, along with the moves needed to get there
+class parallel_solver {
+    friend class solver;
+public:
+    parallel_solver(const game_state&, uint64_t, unsigned);
+
+    // Each thread orders its moves by the history of its own search
+    void enable_history_ordering();
+
+    solver::result run(boost::optional<std::chrono::milliseconds> = boost::none);
+
+    // The solver which found the solution, if there is one
+    const solver& get_solver() const;
+
+private:
+    typedef std::chrono::high_resolution_clock clock;
+
+    void search(shared_cache::thread_id, boost::optional<clock::time_point>);
+    boost::optional<std::vector<move>> take_work();
+    bool give_work(const std::vector<move>&);
+    void finish(solver::result::type, shared_cache::thread_id);
+    bool work_wanted() const;
+    bool stopped() const;
+
+    shared_cache cache;
+    std::vector<std::unique_ptr<solver>> solvers;
+
+    std::mutex work_mutex;
+    std::condition_variable work_cond;
+    std::deque<std::vector<move>> work;
+    unsigned idle;
+    std::atomic<int> wanted;
+    std::atomic<bool> stop;
+
+    solver::result::type outcome;
+    shared_cache::thread_id winner;
+};
+
+#endif //SOLVITAIRE_PARALLEL_SOLVER_H
@@ -0,0 +1,91 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <thread>
+
+#include "portfolio_solver.h"
+
+using std::vector;
+using std::thread;
+using std::lock_guard;
+using std::mutex;
+using boost::optional;
+using rapidjson::Document;
+
+typedef game_state::streamliner_options sos;
+typedef solver::result::type sol_type;
+
+// The solver without streamliners comes first, and the one with both last
+const vector<sos> portfolio_solver::configurations = {
+        sos::NONE, sos::SUIT_SYMMETRY, sos::AUTO_FOUNDATIONS, sos::BOTH
+};
+
+portfolio_solver::portfolio_solver(const sol_rules& rules, optional<int> seed, optional<const Document&> in_doc,
+                                   uint64_t cache_capacity)
+        : results(configurations.size())
+        , stop(false)
+        , winner() {
+    assert(seed || in_doc);
+
+    // The configurations share the cache capacity between them
+    for (sos str_opts : configurations) {
+        game_state gs = seed ? game_state(rules, *seed, str_opts) : game_state(rules, *in_doc, str_opts);
+        solvers.emplace_back(new solver(gs, cache_capacity / configurations.size()));
+        solvers.back()->set_cancel_flag(stop);
+    }
+}
+
+void portfolio_solver::run(optional<std::chrono::milliseconds> timeout) {
+    vector<thread> threads;
+    for (size_t i = 0; i < solvers.size(); i++) {
+        threads.emplace_back(&portfolio_solver::search, this, i, timeout);
+    }
+    for (thread& t : threads) t.join();
+}
+
+void portfolio_solver::search(size_t i, optional<std::chrono::milliseconds> timeout) {
+    solver::result res = solvers[i]->run(timeout);
+
+    lock_guard<mutex> lock(result_mutex);
+    results[i] = res;
+
+    bool conclusive = res.sol_type == sol_type::SOLVED
+            || (configurations[i] == sos::NONE && res.sol_type == sol_type::UNSOLVABLE);
+    if (conclusive && !winner) {
+        winner = i;
+        stop = true;
+    }
+}
+
+bool portfolio_solver::streamliner_solved() const {
+    return winner && configurations[*winner] != sos::NONE;
+}
+
+const solver::result& portfolio_solver::get_streamliner_result() const {
+    return results[streamliner_solved() ? *winner : configurations.size() - 1];
+}
+
+optional<solver::result> portfolio_solver::get_non_streamliner_result() const {
+    if (streamliner_solved()) return boost::none;
+    else return results[0];
+}
+
+const solver& portfolio_solver::get_solver() const {
+    return *solvers[streamliner_solved() ? *winner : 0];
+}
@@ -0,0 +1,66 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SOLVITAIRE_PORTFOLIO_SOLVER_H
+#define SOLVITAIRE_PORTFOLIO_SOLVER_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include <boost/optional.hpp>
+
+#include "solver.h"
+#include "../../../lib/rapidjson/document.h"
+
+// Races solvers over the same deal with each combination of streamliners, on
+// separate threads. The streamliners can make a solvable deal unsolvable, so
+// only a solution, or the search without streamliners running out of states,
+// is conclusive. The first conclusive result stops the other solvers
+class portfolio_solver {
+public:
+    portfolio_solver(const sol_rules&, boost::optional<int>, boost::optional<const rapidjson::Document&>, uint64_t);
+
+    void run(boost::optional<std::chrono::milliseconds> = boost::none);
+
+    // The result of the streamlined solver which found a solution, or of the
+    // solver with both streamliners if none did
+    const solver::result& get_streamliner_result() const;
+    // The result of the solver without streamliners, unless a streamlined
+    // solver found a solution, in which case its result stands alone
+    boost::optional<solver::result> get_non_streamliner_result() const;
+    // The solver whose result is the outcome of the portfolio
+    const solver& get_solver() const;
+
+private:
+    void search(size_t, boost::optional<std::chrono::milliseconds>);
+    bool streamliner_solved() const;
+
+    static const std::vector<game_state::streamliner_options> configurations;
+
+    std::vector<std::unique_ptr<solver>> solvers;
+    std::vector<solver::result> results;
+    std::mutex result_mutex;
+    std::atomic<bool> stop;
+    boost::optional<size_t> winner;
+};
+
+#endif //SOLVITAIRE_PORTFOLIO_SOLVER_H
@@ -0,0 +1,78 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <thread>
+
+#include "restart_portfolio.h"
+
+using std::vector;
+using std::thread;
+using std::lock_guard;
+using std::mutex;
+using boost::optional;
+
+typedef solver::result::type sol_type;
+
+restart_portfolio::restart_portfolio(const game_state& gs, uint64_t cache_capacity, unsigned thread_count,
+                                     uint64_t base_states_)
+        : results(thread_count)
+        , base_states(base_states_)
+        , stop(false)
+        , winner() {
+    assert(thread_count > 0);
+
+    for (unsigned t = 0; t < thread_count; t++) {
+        solvers.emplace_back(new solver(gs, cache_capacity / thread_count));
+        solvers.back()->set_cancel_flag(stop);
+    }
+}
+
+void restart_portfolio::enable_history_ordering() {
+    for (auto& s : solvers) s->enable_history_ordering();
+}
+
+solver::result restart_portfolio::run(optional<std::chrono::milliseconds> timeout) {
+    vector<thread> threads;
+    for (size_t i = 0; i < solvers.size(); i++) {
+        threads.emplace_back(&restart_portfolio::search, this, i, timeout);
+    }
+    for (thread& t : threads) t.join();
+
+    return results[winner ? *winner : 0];
+}
+
+// Each thread is seeded with its index, so the first starts with the usual
+// move order
+void restart_portfolio::search(size_t i, optional<std::chrono::milliseconds> timeout) {
+    solver::result res = solvers[i]->run_restarts(base_states, static_cast<uint32_t>(i), timeout);
+
+    lock_guard<mutex> lock(result_mutex);
+    results[i] = res;
+
+    bool conclusive = res.sol_type == sol_type::SOLVED || res.sol_type == sol_type::UNSOLVABLE;
+    if (conclusive && !winner) {
+        winner = i;
+        stop = true;
+    }
+}
+
+const solver& restart_portfolio::get_solver() const {
+    return *solvers[winner ? *winner : 0];
+}
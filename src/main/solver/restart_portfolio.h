@@ -0,0 +1,61 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SOLVITAIRE_RESTART_PORTFOLIO_H
+#define SOLVITAIRE_RESTART_PORTFOLIO_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include <boost/optional.hpp>
+
+#include "solver.h"
+
+// Races searches with restarts over the same deal, one on each thread, each
+// breaking ties in the move order with a seed of its own. The searches are
+// complete, so the first to finish stops the others. Each thread has its own
+// cache, with a share of the capacity
+class restart_portfolio {
+public:
+    restart_portfolio(const game_state&, uint64_t, unsigned, uint64_t);
+
+    // Each thread orders its moves by the history of its own search
+    void enable_history_ordering();
+
+    solver::result run(boost::optional<std::chrono::milliseconds> = boost::none);
+
+    // The solver which finished first, or the first solver if none did
+    const solver& get_solver() const;
+
+private:
+    void search(size_t, boost::optional<std::chrono::milliseconds>);
+
+    std::vector<std::unique_ptr<solver>> solvers;
+    std::vector<solver::result> results;
+    const uint64_t base_states;
+    std::mutex result_mutex;
+    std::atomic<bool> stop;
+    boost::optional<size_t> winner;
+};
+
+#endif //SOLVITAIRE_RESTART_PORTFOLIO_H
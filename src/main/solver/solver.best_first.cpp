@@ -0,0 +1,165 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <signal.h>
+
+#include "solver.h"
+
+using std::vector;
+using std::pair;
+using std::max;
+using std::begin;
+using std::end;
+using boost::optional;
+
+// Best-first search scores states by the moves to them plus this many times
+// their distance estimate, so leans towards states which look close to solved
+static const uint64_t best_first_weight = 2;
+static const uint32_t no_parent = std::numeric_limits<uint32_t>::max();
+
+solver::result solver::run_best_first(optional<millisec> timeout) {
+    assert(frontier.size() == 1 && cache.size() == 0);
+
+    // Set interrupt handler
+    signal(SIGINT, sigint_handler);
+
+    // Set timings
+    const clock::time_point start_time = clock::now();
+    const optional<clock::time_point> end_time =
+            boost::make_optional(bool(timeout), start_time + timeout.value_or(millisec(0)));
+
+    optional<result::type> best_first_result = best_first(end_time);
+    if (best_first_result) {
+        res.sol_type = *best_first_result;
+
+        // The path to the last state expanded is made the search path, so
+        // that a solution's moves are the outcome's
+        for (auto i = std::next(begin(open_path)); i != end(open_path); i++) {
+            frontier.emplace_back(open_states[*i].mv, 0);
+        }
+        current_node = prev(end(frontier));
+        res.depth = open_path.size() - 1;
+    } else {
+        // The open list can't grow past the cache, so the search starts again
+        // as a DFS, which needs only the path in memory besides the cache
+        go_to_open_state(0);
+        open_states = vector<open_state>();
+        open_list = vector<uint64_t>();
+        // The states removed before the cache is cleared still count
+        uint64_t states_removed = cache.get_states_removed_from_cache();
+        cache.clear();
+        res.depth = 0;
+        res.sol_type = dfs(end_time).sol_type;
+        res.states_removed_from_cache = states_removed;
+    }
+    res.states_removed_from_cache += cache.get_states_removed_from_cache();
+    res.cache_size = cache.size();
+    res.cache_bucket_count = cache.bucket_count();
+    res.time = std::chrono::duration_cast<millisec>(clock::now() - start_time);
+
+    return res;
+}
+
+optional<solver::result::type> solver::best_first(optional<clock::time_point> end_time) {
+    const uint64_t removed_before = cache.get_states_removed_from_cache();
+    vector<move> children;
+
+    // A state's score is in the top half of its entry, and the bottom half
+    // breaks ties in favour of the states found last, as DFS would
+    auto push = [this](uint64_t score, uint32_t index) {
+        open_list.push_back(score << 32 | (no_parent - index));
+        std::push_heap(begin(open_list), end(open_list), std::greater<uint64_t>());
+    };
+
+    try {
+        cache.set_non_live(cache.insert(state).first);
+        open_states.push_back(open_state{no_parent, move(move::mtype::null)});
+        open_path.assign(1, 0);
+        push(best_first_weight * state.distance_estimate(), 0);
+
+        while (!open_list.empty()) {
+            if (end_time && clock::now() >= *end_time) {
+                return solver::result::type::TIMEOUT;
+            } else if (interrupted()) {
+                return solver::result::type::TERMINATED;
+            }
+
+            std::pop_heap(begin(open_list), end(open_list), std::greater<uint64_t>());
+            const auto index = static_cast<uint32_t>(no_parent - (open_list.back() & no_parent));
+            open_list.pop_back();
+
+            go_to_open_state(index);
+            res.states_searched++;
+            res.max_depth = max(uint64_t(open_path.size() - 1), res.max_depth);
+            if (state.is_solved()) return solver::result::type::SOLVED;
+
+            // A dominance move is the only child of its state
+            children.clear();
+            optional<move> dominance_move = state.get_dominance_move();
+            if (dominance_move) children.push_back(*dominance_move);
+            else state.get_legal_moves(children, open_states[index].mv);
+
+            for (move m : children) {
+                state.make_move(m);
+                pair<lru_cache::handle, bool> insert_res = cache.insert(state);
+                if (insert_res.second) {
+                    cache.set_non_live(insert_res.first);
+                    open_states.push_back(open_state{index, m});
+                    push(open_path.size() + best_first_weight * state.distance_estimate(),
+                         static_cast<uint32_t>(open_states.size() - 1));
+                    res.unique_states_searched++;
+                    if (m.dominance_move) res.dominance_moves++;
+                }
+                state.undo_move(m);
+
+                if (cache.get_states_removed_from_cache() != removed_before) return boost::none;
+            }
+        }
+    } catch (const std::runtime_error &e) {
+        return boost::none;
+    }
+    return solver::result::type::UNSOLVABLE;
+}
+
+// Takes the state to the given open state, going back up the path to the last
+// state the two have in common and down to the open state from there
+void solver::go_to_open_state(uint32_t index) {
+    target_path.clear();
+    for (uint32_t i = index; i != no_parent; i = open_states[i].parent) {
+        target_path.push_back(i);
+    }
+    std::reverse(begin(target_path), end(target_path));
+
+    auto common = std::mismatch(begin(open_path), end(open_path), begin(target_path), end(target_path));
+    const auto common_size = static_cast<size_t>(common.first - begin(open_path));
+    while (open_path.size() > common_size) {
+        state.undo_move(open_states[open_path.back()].mv);
+        open_path.pop_back();
+        res.backtracks++;
+    }
+    for (auto i = begin(target_path) + common_size; i != end(target_path); i++) {
+        state.make_move(open_states[*i].mv);
+        open_path.push_back(*i);
+    }
+}
@@ -30,8 +30,11 @@
 #include <chrono>
 #include <iomanip>
 #include <signal.h>
+#include <type_traits>
+#include <limits>
 
 #include "solver.h"
+#include "parallel_solver.h"
 #include "../game/move.h"
 #include "../input-output/output/log_helper.h"
 #include "../input-output/output/state_printer.h"
@@ -51,6 +54,27 @@ using std::setprecision;
 
 static bool sigint = false;
 
+// Moves are keyed for history ordering by the kinds of pile they go between
+// (one more for moves without a pile) and by the card they move (with the last
+// key for moves without one)
+static const uint16_t pile_kind_count = 10;
+static const uint16_t history_cards = 64;
+// The credit a move gets for being part of a solution, over that for finding a
+// new state
+static const uint64_t solution_credit = 64;
+
+// The depth a state searched by DFS is cached with, so that it is only searched
+// again if marked as unsearched, as the states of a stopped search are
+static const uint32_t searched_in_full = std::numeric_limits<uint32_t>::max();
+
+// The ith term of the Luby sequence, counting from 1
+static uint64_t luby(uint64_t i) {
+    uint64_t k = 1;
+    while ((uint64_t(1) << k) - 1 < i) k++;
+    if ((uint64_t(1) << k) - 1 == i) return uint64_t(1) << (k - 1);
+    return luby(i - (uint64_t(1) << (k - 1)) + 1);
+}
+
 void sigint_handler(int i) {
     // So it doesn't complain about unused param
     sigint = i == 1 ? true : true;
@@ -61,10 +85,35 @@ solver::solver(const game_state& gs, uint64_t cache_capacity)
         , init_state(gs)
         , state(gs)
         , frontier()
-        , root(move(move::mtype::null))
-        , current_node() {
+        , move_stack()
+        , root(move(move::mtype::null), 0)
+        , current_node()
+        , pool(nullptr)
+        , thread(0)
+        , cancel(nullptr)
+        , limits{0, boost::none}
+        , moves_left_out(false)
+        , sleep_sets(true)
+        , sleep_stack()
+        , chain_stack()
+        , lookahead(true)
+        , history()
+        , pile_kinds()
+        , scored_moves()
+        , tie_break()
+        , proof_frames()
+        , proof_children()
+        , path_depths()
+        , rollout_rng(0)
+        , playout_states()
+        , rollout_stopped(false)
+        , open_states()
+        , open_list()
+        , open_path()
+        , target_path() {
     frontier.push_back(root);
     current_node = begin(frontier);
+    init_pile_kinds();
     res.states_searched = 0;
     res.unique_states_searched = 0;
     res.backtracks = 0;
@@ -74,8 +123,27 @@ solver::solver(const game_state& gs, uint64_t cache_capacity)
     res.depth = 0;
 }
 
-solver::node::node(const move m) noexcept
-        : mv(m), child_moves(), cache_state() {
+solver::solver(const game_state& gs, parallel_solver& ps, shared_cache::thread_id t)
+        : solver(gs, 0) {
+    pool = &ps;
+    thread = t;
+    // Moves another thread has taken over aren't searched in full by the time
+    // they're left, so can't go into sleep sets
+    sleep_sets = false;
+    lookahead = false;
+}
+
+solver::node::node(const move m, uint32_t moves_top, uint16_t key) noexcept
+        : mv(m), first_child(moves_top), last_child(moves_top), cache_state(), history_key(key)
+        , discrepancies(0), child_taken(false), sleep_first(0), chain_first(0) {
+}
+
+bool solver::node::has_children() const {
+    return first_child != last_child;
+}
+
+bool solver::search_limits::limited() const {
+    return beam_width > 0 || discrepancies;
 }
 
 solver::result solver::run(boost::optional<millisec> timeout) {
@@ -88,6 +156,10 @@ solver::result solver::run(boost::optional<millisec> timeout) {
     // non-optimal solution:
     result dfs_reult = timeout ? dfs(start_time + *timeout) : dfs();
     res.sol_type = dfs_reult.sol_type;
+    // Without every move tried, running out of states doesn't show there's no solution
+    if (res.sol_type == solver::result::type::UNSOLVABLE && moves_left_out) {
+        res.sol_type = solver::result::type::INCONCLUSIVE;
+    }
     res.states_removed_from_cache = cache.get_states_removed_from_cache();
     res.cache_size = cache.size();
     res.cache_bucket_count = cache.bucket_count();
@@ -96,6 +168,63 @@ solver::result solver::run(boost::optional<millisec> timeout) {
      return res;
 }
 
+void solver::set_cancel_flag(const std::atomic<bool>& flag) {
+    cancel = &flag;
+}
+
+bool solver::interrupted() const {
+    return sigint || (cancel && *cancel);
+}
+
+void solver::enable_history_ordering() {
+    history.assign(pile_kind_count * pile_kind_count * history_cards, history_entry{0, 0});
+}
+
+void solver::disable_sleep_sets() {
+    sleep_sets = false;
+}
+
+void solver::disable_transposition_lookahead() {
+    lookahead = false;
+}
+
+void solver::set_search_limits(search_limits l) {
+    limits = l;
+}
+
+solver::result solver::run_restarts(uint64_t base_states, uint32_t seed, optional<millisec> timeout) {
+    // Set interrupt handler
+    signal(SIGINT, sigint_handler);
+
+    // Set timings
+    const clock::time_point start_time = clock::now();
+    const optional<clock::time_point> end_time =
+            boost::make_optional(bool(timeout), start_time + timeout.value_or(millisec(0)));
+
+    result dfs_result;
+    for (uint64_t run = 1;; run++) {
+        if (!tie_break && (run > 1 || seed != 0)) {
+            tie_break.emplace(seed);
+        }
+
+        // The states on the path of the last run are left to be searched again
+        return_to_root();
+        dfs_result = dfs(end_time, res.states_searched + luby(run) * base_states);
+
+        bool out_of_states = dfs_result.sol_type == solver::result::type::TIMEOUT
+                             && !(end_time && clock::now() >= *end_time);
+        if (!out_of_states) break;
+    }
+
+    res.sol_type = dfs_result.sol_type;
+    res.states_removed_from_cache = cache.get_states_removed_from_cache();
+    res.cache_size = cache.size();
+    res.cache_bucket_count = cache.bucket_count();
+    res.time = std::chrono::duration_cast<millisec>(clock::now() - start_time);
+
+    return res;
+}
+
 solver::result solver::run_DLS(uint64_t depth_limit, boost::optional<millisec> timeout) {
     // Set interrupt handler
     signal(SIGINT, sigint_handler);
@@ -103,6 +232,11 @@ solver::result solver::run_DLS(uint64_t depth_limit, boost::optional<millisec> t
     // Set timings
     const clock::time_point start_time = clock::now();
 
+    // A solver can be run again with another depth limit, reusing its cache
+    return_to_root();
+    // Depth-limited searches are kept exhaustive, as their bounds must be exact
+    sleep_sets = false;
+
     result dls_reult = timeout ? dls(depth_limit, start_time + *timeout) : dls(depth_limit);
     res.sol_type = dls_reult.sol_type;
     res.states_removed_from_cache = cache.get_states_removed_from_cache();
@@ -114,19 +248,25 @@ solver::result solver::run_DLS(uint64_t depth_limit, boost::optional<millisec> t
 }
 
 
-solver::result solver::dfs(boost::optional<clock::time_point> end_time) {
+solver::result solver::dfs(boost::optional<clock::time_point> end_time, boost::optional<uint64_t> state_limit) {
     bool states_exhausted = false;
     result result;
 
     while(!(state.is_solved() || states_exhausted)) {
-        if (end_time && clock::now() >= *end_time) {
+        if ((end_time && clock::now() >= *end_time) || (state_limit && res.states_searched >= *state_limit)) {
             result.sol_type = solver::result::type::TIMEOUT;
             return result;
-        } else if (sigint) {
+        } else if (sigint || (pool && pool->stopped()) || (cancel && *cancel)) {
             result.sol_type = solver::result::type::TERMINATED;
             return result;
         }
 
+        // If another thread of a parallel search has run out of work, gives
+        // it some of ours
+        if (pool && pool->work_wanted()) {
+            donate_work();
+        }
+
 #ifndef NDEBUG
         if (current_node->mv.dominance_move) {
             LOG_DEBUG("(dominance move)");
@@ -135,27 +275,30 @@ solver::result solver::dfs(boost::optional<clock::time_point> end_time) {
 #endif
 
         // If there is a dominance move available, adds it to the search tree
-        // and repeats. Doesn't cache the state.
-        optional<move> dominance_move = state.get_dominance_move();
+        // and repeats. Doesn't cache the state. The rest of the chain of
+        // dominance moves is made along with it, so a state reached by one has
+        // none left
+        optional<move> dominance_move;
+        if (!current_node->mv.dominance_move) dominance_move = state.get_dominance_move();
         if (dominance_move) {
             // Adds the dominance move as a child of the current search node;
-            current_node->child_moves.emplace_back(*dominance_move);
+            add_child(*dominance_move);
         } else {
             try {
                 // Caches the current state
-                pair<lru_cache::item_list::iterator, bool> insert_res = cache.insert(state);
+                pair<lru_cache::handle, bool> insert_res = insert_state();
                 current_node->cache_state = insert_res.first;
                 bool is_new_state = insert_res.second;
                 
                 if (is_new_state) {
-                    // Gets the legal moves in the current state
-                    vector<move> next_moves = state.get_legal_moves(current_node->mv);
+                    credit_new_state();
+
+                    // Adds the legal moves in the current state as children
+                    add_legal_children();
 
                     // If there are none, reverts to the last node with children
-                    if (next_moves.empty()) {
+                    if (!current_node->has_children()) {
                         states_exhausted = revert_to_last_node_with_children(insert_res.first);
-                    } else {
-                        current_node->child_moves = std::move(next_moves);
                     }
                 }
                     // If the state is not a new one, reverts to the last node with children
@@ -170,13 +313,19 @@ solver::result solver::dfs(boost::optional<clock::time_point> end_time) {
         }
 
         // Sets the current node to one of its children
-        assert(states_exhausted == current_node->child_moves.empty());
+        if (!states_exhausted && lookahead && !limits.discrepancies) {
+            states_exhausted = skip_cached_children();
+        }
+        assert(states_exhausted == !current_node->has_children());
         if (!states_exhausted) {
             set_to_child();
             state.make_move(current_node->mv);
             res.depth++;
             res.max_depth = max(res.depth, res.max_depth);
-            if (current_node->mv.dominance_move) res.dominance_moves++;
+            if (current_node->mv.dominance_move) {
+                res.dominance_moves++;
+                make_dominance_chain();
+            }
         }
 
         res.states_searched++;
@@ -184,6 +333,7 @@ solver::result solver::dfs(boost::optional<clock::time_point> end_time) {
     }
 
     if (state.is_solved()) {
+        credit_solution();
         result.sol_type = solver::result::type::SOLVED;
         return result;
     } else {
@@ -202,7 +352,7 @@ solver::result solver::dls(uint64_t depth_limit, boost::optional<clock::time_poi
         if (end_time && clock::now() >= *end_time) {
             result_dls.sol_type = solver::result::type::TIMEOUT;
             return result_dls;
-        } else if (sigint) {
+        } else if (interrupted()) {
             result_dls.sol_type = solver::result::type::TERMINATED;
             return result_dls;
         }
@@ -214,31 +364,38 @@ solver::result solver::dls(uint64_t depth_limit, boost::optional<clock::time_poi
         LOG_DEBUG(state);
 #endif
 
+        // A state is only expanded if a solution from it could still be
+        // within the depth limit, which takes at least one move, and at least
+        // as many as the heuristic's lower bound for the state
+        uint64_t min_solution_depth = res.depth + max(state.min_moves_to_solve(), uint32_t(1));
+        bool within_limit = min_solution_depth <= depth_limit;
+
         // If there is a dominance move available, adds it to the search tree
         // and repeats. Doesn't cache the state.
         optional<move> dominance_move = state.get_dominance_move();
-        if (dominance_move && res.depth < depth_limit) { // -- diffrence from DFS
+        if (dominance_move && within_limit) { // -- diffrence from DFS
             // Adds the dominance move as a child of the current search node;
-            current_node->child_moves.emplace_back(*dominance_move);
+            add_child(*dominance_move);
         } else {
             try {
-                // Caches the current state
-                pair<lru_cache::item_list::iterator, bool> insert_res = cache.insert(state);
+                // Caches the current state, with the depth left below it.
+                // A state already searched to at least that depth is skipped
+                auto depth_left = static_cast<uint32_t>(depth_limit - res.depth);
+                pair<lru_cache::handle, bool> insert_res = cache.insert(state, depth_left);
                 current_node->cache_state = insert_res.first;
                 bool is_new_state = insert_res.second;
                 if (is_new_state) {
+                    credit_new_state();
+
                     // search up to depth: depth_limit.
-                    vector<move> next_moves;
-                    if (res.depth < depth_limit) {  // -- diffrence from DFS
-                    // Gets the legal moves in the current state
-                         next_moves = state.get_legal_moves(current_node->mv);
+                    if (within_limit) {  // -- diffrence from DFS
+                    // Adds the legal moves in the current state as children
+                         add_legal_children();
                     }
 
                     // If there are none, reverts to the last node with children
-                    if (next_moves.empty()) {
+                    if (!current_node->has_children()) {
                         states_exhausted = revert_to_last_node_with_children(insert_res.first);
-                    } else {
-                        current_node->child_moves = std::move(next_moves);
                     }
                 }
                     // If the state is not a new one, reverts to the last node with children
@@ -253,7 +410,7 @@ solver::result solver::dls(uint64_t depth_limit, boost::optional<clock::time_poi
         }
 
         // Sets the current node to one of its children
-        assert(states_exhausted == current_node->child_moves.empty());
+        assert(states_exhausted == !current_node->has_children());
         if (!states_exhausted) {
             set_to_child();
             state.make_move(current_node->mv);
@@ -267,6 +424,7 @@ solver::result solver::dls(uint64_t depth_limit, boost::optional<clock::time_poi
     }
 
     if (state.is_solved()) {
+        credit_solution();
         result_dls.sol_type = solver::result::type::SOLVED;
         return result_dls;
     } else {
@@ -282,13 +440,14 @@ solver::result solver::dls(uint64_t depth_limit, boost::optional<clock::time_poi
 
 // If an iterator to the current state is supplied to the function, will also
 // make sure to turn the 'live' bit off upon backtracking
-bool solver::revert_to_last_node_with_children(optional<lru_cache::item_list::iterator> cur_state) {
+bool solver::revert_to_last_node_with_children(optional<lru_cache::handle> cur_state) {
     if (current_node == begin(frontier))
         return true;
 
     // Turns the 'live' bit false on the state we are backtracking out of
-    if (cur_state) cache.set_non_live(*cur_state);
+    if (cur_state) release_state(*cur_state);
 
+    undo_dominance_chain();
     state.undo_move(current_node->mv);
     res.depth--;
     res.backtracks++;
@@ -298,7 +457,9 @@ bool solver::revert_to_last_node_with_children(optional<lru_cache::item_list::it
     // (as long as the move wasn't a dominance move)
 
     if (! current_node->mv.dominance_move) {
-        if (cache.get_states_removed_from_cache() == 0) {
+        if (pool) {
+            assert(pool->cache.contains(state));
+        } else if (cache.get_states_removed_from_cache() == 0) {
             assert(cache.contains(state));
         }
         LOG_DEBUG("(undo move)");
@@ -310,43 +471,388 @@ bool solver::revert_to_last_node_with_children(optional<lru_cache::item_list::it
 
     // Gets a reference to the parent state which can be supplied if this function is
     // called recursively. This ensures that the cached state's 'live' bit is set as appropriate
-    optional<lru_cache::item_list::iterator> p_state = prev(current_node)->cache_state;
+    optional<lru_cache::handle> p_state = prev(current_node)->cache_state;
+
+    // The node's move has now been tried, so goes into its parent's sleep set
+    if (sleep_sets) {
+        sleep_stack.erase(begin(sleep_stack) + current_node->sleep_first, end(sleep_stack));
+        if (!current_node->mv.dominance_move) sleep_stack.push_back(current_node->mv);
+    }
 
     // Reverts the current node to its parent and removes it
     frontier.pop_back();
     current_node = prev(end(frontier));
+    // Drops any of the node's moves which were given to other threads
+    move_stack.erase(begin(move_stack) + current_node->last_child, end(move_stack));
 
     // If the current node now has no children, repeat
-    if (current_node->child_moves.empty()) {
+    if (!current_node->has_children()) {
         return revert_to_last_node_with_children(p_state);
     } else {
         return false;
     }
 }
 
+void solver::add_child(move m) {
+    assert(move_stack.size() == current_node->last_child);
+
+    move_stack.push_back(m);
+    current_node->last_child++;
+}
+
+// Generates the legal moves straight onto the move stack
+void solver::add_legal_children() {
+    assert(move_stack.size() == current_node->last_child);
+
+    state.get_legal_moves(move_stack, current_node->mv);
+    current_node->last_child = static_cast<uint32_t>(move_stack.size());
+
+    if (tie_break) shuffle_tied_children();
+    if (!history.empty()) order_children();
+    if (sleep_sets) remove_sleeping_children();
+    if (limits.limited()) limit_children();
+}
+
+// Whether the moves, both legal in the current state, lead to the same state
+// in either order and leave each other legal. Moves of single cards between
+// four different piles do, as whether each is legal only depends on its own
+// piles. Emptying or filling other piles than cells and foundations could
+// change which moves are allowed, as in games with an auto-reserve, so moves
+// which do aren't counted
+bool solver::commutes(move a, move b) const {
+    const vector<pile>& piles = state.get_data();
+    auto kind = [this](pile::ref pr) { return static_cast<game_state::pile_kind>(pile_kinds[pr]); };
+    auto simple = [&piles, &kind](move m) {
+        return m.type == move::mtype::regular
+               && (piles[m.from].size() > 1 || kind(m.from) == game_state::pile_kind::CELL)
+               && (!piles[m.to].empty() || kind(m.to) == game_state::pile_kind::CELL
+                   || kind(m.to) == game_state::pile_kind::FOUNDATION);
+    };
+    return simple(a) && simple(b)
+           && a.from != b.from && a.from != b.to && a.to != b.from && a.to != b.to;
+}
+
+// Drops the current node's moves which are in its sleep set
+void solver::remove_sleeping_children() {
+    const auto sleep_begin = begin(sleep_stack) + current_node->sleep_first;
+    if (sleep_begin == end(sleep_stack)) return;
+
+    auto first = begin(move_stack) + current_node->first_child;
+    auto sleeping = [sleep_begin, this](move m) {
+        return std::any_of(sleep_begin, end(sleep_stack), [m](move s) {
+            return s.from == m.from && s.to == m.to && s.type == m.type && s.count == m.count;
+        });
+    };
+    move_stack.erase(std::remove_if(first, end(move_stack), sleeping), end(move_stack));
+    current_node->last_child = static_cast<uint32_t>(move_stack.size());
+}
+
+// Drops the next moves of the DFS while they lead to states in the cache which
+// needn't be searched again, backtracking from nodes left without moves. The
+// hash of each move's state is worked out from the move, which is only made to
+// compare the keys if the hash is found. A move dropped counts as tried for the
+// sleep sets, as it would once the search had come back from its state.
+// Returns whether the states have been exhausted
+bool solver::skip_cached_children() {
+    while (current_node->has_children()) {
+        const move m = move_stack.back();
+        optional<uint64_t> h = state.hash_after(m);
+        if (!h || !cache.may_contain(*h)) return false;
+
+        state.make_move(m);
+        assert(state.get_hash() == *h);
+        bool covered = cache.covers(state, searched_in_full);
+        state.undo_move(m);
+        if (!covered) return false;
+
+        move_stack.pop_back();
+        current_node->last_child--;
+        if (sleep_sets && !m.dominance_move) sleep_stack.push_back(m);
+
+        if (!current_node->has_children()
+            && revert_to_last_node_with_children(current_node->cache_state)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drops all but the moves of the current node to be tried first, which are the
+// ones at the top of the stack
+void solver::limit_children() {
+    uint32_t width = limits.beam_width > 0 ? limits.beam_width : std::numeric_limits<uint32_t>::max();
+    if (limits.discrepancies && current_node->discrepancies >= *limits.discrepancies) width = 1;
+
+    if (current_node->last_child - current_node->first_child <= width) return;
+    move_stack.erase(begin(move_stack) + current_node->first_child, end(move_stack) - width);
+    current_node->last_child = current_node->first_child + width;
+    moves_left_out = true;
+}
+
 void solver::set_to_child() {
-    assert(!current_node->child_moves.empty());
+    assert(current_node->has_children());
+    assert(move_stack.size() == current_node->last_child);
+
+    move b = move_stack.back();
+    move_stack.pop_back();
+    const uint32_t moves_top = --current_node->last_child;
+
+    uint16_t key = 0;
+    if (!history.empty()) {
+        key = history_key(b);
+        if (!b.dominance_move) history[key].tries++;
+    }
 
-    move b = current_node->child_moves.back();
-    current_node->child_moves.pop_back();
-    frontier.emplace_back(b);
+    // Each move tried after a node's first is a discrepancy
+    const auto discrepancies = static_cast<uint8_t>(current_node->discrepancies + current_node->child_taken);
+    current_node->child_taken = true;
+
+    // The child's sleep set is the moves of the node's sleep set, and those it
+    // has tried, which commute with the child's move
+    const auto sleep_first = static_cast<uint32_t>(sleep_stack.size());
+    if (sleep_sets) {
+        for (uint32_t i = current_node->sleep_first; i < sleep_first; i++) {
+            if (commutes(sleep_stack[i], b)) sleep_stack.push_back(sleep_stack[i]);
+        }
+    }
+    frontier.emplace_back(b, moves_top, key);
 
     current_node = prev(end(frontier));
+    current_node->discrepancies = discrepancies;
+    current_node->sleep_first = sleep_first;
+    current_node->chain_first = static_cast<uint32_t>(chain_stack.size());
+}
+
+// Makes the dominance moves which follow the current node's, as one step,
+// though each still counts towards the depth. The node's sleep set keeps the
+// moves which commute with all of them, as it would have with a node for each
+void solver::make_dominance_chain() {
+    for (optional<move> m = state.get_dominance_move(); m; m = state.get_dominance_move()) {
+        if (sleep_sets) {
+            const move d = *m;
+            sleep_stack.erase(std::remove_if(begin(sleep_stack) + current_node->sleep_first, end(sleep_stack),
+                                             [this, d](move s) { return !commutes(s, d); }),
+                              end(sleep_stack));
+        }
+        state.make_move(*m);
+        chain_stack.push_back(*m);
+        res.dominance_moves++;
+        res.depth++;
+    }
+    res.max_depth = max(res.depth, res.max_depth);
+}
+
+void solver::undo_dominance_chain() {
+    while (chain_stack.size() > current_node->chain_first) {
+        state.undo_move(chain_stack.back());
+        chain_stack.pop_back();
+        res.depth--;
+    }
+}
+
+// Appends the moves from the initial state to the given node of the frontier,
+// including those of the dominance chains on the way
+void solver::add_path_moves(vector<move>& moves, vector<node>::const_iterator last) const {
+    for (auto i = std::next(begin(frontier)); i != std::next(last); i++) {
+        moves.push_back(i->mv);
+        uint32_t chain_last = std::next(i) == end(frontier) ? static_cast<uint32_t>(chain_stack.size())
+                                                            : std::next(i)->chain_first;
+        moves.insert(end(moves), begin(chain_stack) + i->chain_first, begin(chain_stack) + chain_last);
+    }
+}
+
+// Takes the search back to the initial state after a search has stopped, if it
+// has run before. The states on the path were only partly searched, so are
+// marked as unsearched in the cache, while those searched in full stay there
+void solver::return_to_root() {
+    while (true) {
+        if (current_node->cache_state) cache.set_unsearched(*current_node->cache_state);
+        if (current_node == begin(frontier)) break;
+
+        undo_dominance_chain();
+        state.undo_move(current_node->mv);
+        frontier.pop_back();
+        current_node = prev(end(frontier));
+    }
+
+    move_stack.clear();
+    sleep_stack.clear();
+    current_node->first_child = current_node->last_child = 0;
+    current_node->cache_state = boost::none;
+    current_node->child_taken = false;
+    res.depth = 0;
+}
+
+void solver::init_pile_kinds() {
+    pile_kinds.clear();
+    for (pile::ref pr = 0; pr < state.get_data().size(); pr++) {
+        pile_kinds.push_back(static_cast<uint8_t>(state.get_pile_kind(pr)));
+    }
+}
+
+// The kinds of pile a move goes between
+uint16_t solver::move_kind(move m) const {
+    auto kind = [this](pile::ref pr) {
+        return pr < pile_kinds.size() ? pile_kinds[pr] : pile_kind_count - 1;
+    };
+    return static_cast<uint16_t>(kind(m.from) * pile_kind_count + kind(m.to));
+}
+
+// Shuffles each run of moves between the same kinds of pile. The move generator
+// adds moves in order of priority, with each kind of move together
+void solver::shuffle_tied_children() {
+    auto first = begin(move_stack) + current_node->first_child;
+    const auto last = begin(move_stack) + current_node->last_child;
+    while (first != last) {
+        const uint16_t kind = move_kind(*first);
+        auto run_end = std::find_if(first, last, [this, kind](move m) { return move_kind(m) != kind; });
+        std::shuffle(first, run_end, *tie_break);
+        first = run_end;
+    }
+}
+
+// Keys a move in the current state by the kinds of pile it goes between, and by
+// the card it moves, or the base of the group moved. Stock moves which deal
+// past cards, and moves to every tableau pile at once, are keyed without a card
+uint16_t solver::history_key(move m) const {
+    uint16_t card_key = history_cards - 1;
+    bool moves_from_top = m.type == move::mtype::regular
+                          || m.type == move::mtype::built_group
+                          || m.type == move::mtype::sequence
+                          || m.type == move::mtype::accordion;
+    if (moves_from_top && m.from < pile_kinds.size() && m.count > 0) {
+        const pile& from = state.get_data()[m.from];
+        auto depth = static_cast<pile::size_type>(m.type == move::mtype::built_group ? m.count - 1 : 0);
+        if (depth < from.size()) {
+            card c = from[depth];
+            card_key = static_cast<uint16_t>(c.get_rank() * 4 + c.get_suit());
+            assert(card_key < history_cards - 1);
+        }
+    }
+
+    return static_cast<uint16_t>(move_kind(m) * history_cards + card_key);
+}
+
+// The credit moves like this one have had per try. It is smoothed, so that
+// kinds of move not yet tried score in the middle
+double solver::history_score(move m) const {
+    const history_entry& e = history[history_key(m)];
+    return (double(e.credit) + 1) / (double(e.tries) + 2);
+}
+
+// Sorts the current node's moves by their history scores. Moves are taken from
+// the top of the stack, so the highest scoring go last. The sort is stable, so
+// ties are still broken by the order the moves were generated in
+void solver::order_children() {
+    scored_moves.clear();
+    for (uint32_t i = current_node->first_child; i < current_node->last_child; i++) {
+        scored_moves.emplace_back(history_score(move_stack[i]), move_stack[i]);
+    }
+    std::stable_sort(begin(scored_moves), end(scored_moves),
+            [](const pair<double, move>& a, const pair<double, move>& b) {
+                return a.first < b.first;
+            });
+    for (uint32_t i = 0; i < scored_moves.size(); i++) {
+        move_stack[current_node->first_child + i] = scored_moves[i].second;
+    }
+}
+
+// Credits the move to the current state for having found a new one, twice over
+// if it revealed a card
+void solver::credit_new_state() {
+    if (history.empty() || current_node == begin(frontier) || current_node->mv.dominance_move) return;
+    history[current_node->history_key].credit += current_node->mv.reveal_move ? 2 : 1;
+}
+
+void solver::credit_solution() {
+    if (history.empty()) return;
+    for (auto i = std::next(begin(frontier)); i != end(frontier); i++) {
+        if (!i->mv.dominance_move) history[i->history_key].credit += solution_credit;
+    }
+}
+
+// Caches the current state, in the shared cache if this is one of the threads
+// of a parallel search
+pair<lru_cache::handle, bool> solver::insert_state() {
+    static_assert(std::is_same<lru_cache::handle, shared_cache::handle>::value,
+                  "Cache handles must be interchangeable");
+    if (pool) return pool->cache.insert(state, thread);
+    // With a discrepancy limit, one more than the discrepancies left, as 0
+    // marks states as unsearched
+    if (limits.discrepancies) {
+        return cache.insert(state, uint32_t(*limits.discrepancies - current_node->discrepancies) + 1);
+    }
+    return cache.insert(state, searched_in_full);
+}
+
+void solver::release_state(lru_cache::handle h) {
+    if (pool) pool->cache.set_explored(h);
+    else cache.set_non_live(h);
+}
+
+// Gives an untried move from the shallowest node with one to the parallel
+// search, along with the moves leading to that node. The move given away is the
+// one which would have been tried last
+void solver::donate_work() {
+    auto open_node = std::find_if(begin(frontier), current_node,
+            [](const node& n) { return n.has_children(); });
+    if (open_node == current_node) return;
+
+    vector<move> prefix;
+    add_path_moves(prefix, open_node);
+    prefix.push_back(move_stack[open_node->first_child]);
+
+    if (pool->give_work(prefix)) {
+        open_node->first_child++;
+    }
+}
+
+// Replays the supplied moves from the initial state, which the solver must be
+// back at. The nodes on the way have no children, so the search ends once the
+// subtree below the final move has been exhausted
+void solver::start_from(const vector<move>& prefix) {
+    assert(frontier.size() == 1 && res.depth == 0);
+
+    // Clears out the moves given away while the last subtree was searched
+    move_stack.clear();
+    frontier.front().first_child = frontier.front().last_child = 0;
+
+    for (move m : prefix) {
+        frontier.emplace_back(m, 0, history.empty() ? uint16_t(0) : history_key(m));
+        state.make_move(m);
+    }
+    current_node = prev(end(frontier));
+
+    res.depth = prefix.size();
+    res.max_depth = max(res.depth, res.max_depth);
+}
+
+solver::outcome solver::get_outcome() const {
+    vector<move> moves;
+    add_path_moves(moves, prev(end(frontier)));
+    return outcome(init_state, res, std::move(moves));
 }
 
 void solver::print_solution() const {
+    get_outcome().print_solution();
+}
+
+solver::outcome::outcome(const game_state& gs, result r, vector<move> mvs)
+        : init_state(gs), res(r), moves(std::move(mvs)) {
+}
+
+void solver::outcome::print_solution() const {
     std::flush(clog);
     std::flush(cout);
 
-    auto i = begin(frontier);
     game_state state_copy = init_state;
 
     cout << "Solution:\n";
     cout << state_copy << "\n";
 
     if (res.states_searched > 1) {
-        while (++i != end(frontier)) {
-            state_copy.make_move(i->mv);
+        for (move m : moves) {
+            state_copy.make_move(m);
             cout << state_copy << "\n";
         }
     }
@@ -370,6 +876,9 @@ std::ostream& operator<< (std::ostream& out, const solver::result::type& rt) {
         case solver::result::type::TERMINATED:
             out << "terminated";
             break;
+        case solver::result::type::INCONCLUSIVE:
+            out << "inconclusive";
+            break;
     }
     return out;
 }
@@ -391,7 +900,8 @@ std::ostream& operator<< (std::ostream& out, const solver::result& r) {
 
 void solver::print_header(long t, command_line_helper::streamliner_opt stream_opt) {
     cout << "Calculating solvability percentage...\n\n";
-    if (stream_opt == command_line_helper::streamliner_opt::SMART) {
+    if (stream_opt == command_line_helper::streamliner_opt::SMART
+            || stream_opt == command_line_helper::streamliner_opt::PORTFOLIO) {
         cout << ", (Streamliner Results:) "
                 "Attempted Seed"
                 ", Outcome"
@@ -0,0 +1,233 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <signal.h>
+
+#include "solver.h"
+
+using std::max;
+using std::pair;
+using boost::optional;
+
+// Proof and disproof numbers are summed and incremented without overflowing
+// into the value for infinity
+static const uint64_t infinite_proof = std::numeric_limits<uint64_t>::max();
+static const uint32_t no_loop = std::numeric_limits<uint32_t>::max();
+
+static uint64_t saturating_add(uint64_t a, uint64_t b) {
+    return a >= infinite_proof - 1 - b ? infinite_proof - 1 : a + b;
+}
+
+solver::result solver::run_DFPN(optional<millisec> timeout) {
+    // Set interrupt handler
+    signal(SIGINT, sigint_handler);
+
+    // Set timings
+    const clock::time_point start_time = clock::now();
+
+    result dfpn_result = timeout ? dfpn(start_time + *timeout) : dfpn();
+    res.sol_type = dfpn_result.sol_type;
+    res.states_removed_from_cache = cache.get_states_removed_from_cache();
+    res.cache_size = cache.size();
+    res.cache_bucket_count = cache.bucket_count();
+    res.time = std::chrono::duration_cast<millisec>(clock::now() - start_time);
+
+    return res;
+}
+
+solver::result solver::dfpn(optional<clock::time_point> end_time) {
+    assert(frontier.size() == 1 && cache.size() == 0);
+    result result_dfpn;
+
+    cache.enable_proof_numbers();
+    try {
+        // The initial state has no thresholds, so is only left once disproved
+        lru_cache::handle root_state = cache.insert(state).first;
+        current_node->cache_state = root_state;
+        path_depths[root_state] = 0;
+        proof_frames.push_back(proof_frame{infinite_proof, infinite_proof, 0, 0});
+        res.states_searched++;
+        res.unique_states_searched++;
+
+        bool solved = state.is_solved() || add_proof_children();
+        while (!solved) {
+            if (end_time && clock::now() >= *end_time) {
+                result_dfpn.sol_type = solver::result::type::TIMEOUT;
+                return result_dfpn;
+            } else if (interrupted()) {
+                result_dfpn.sol_type = solver::result::type::TERMINATED;
+                return result_dfpn;
+            }
+
+            proof_frame& frame = proof_frames.back();
+
+            // The proof number of the node is the least of its children's, and
+            // the disproof number their sum
+            uint64_t proof = infinite_proof;
+            uint64_t second_proof = infinite_proof;
+            uint64_t disproof = 0;
+            uint32_t best = frame.first_child;
+            for (uint32_t i = frame.first_child; i < proof_children.size(); i++) {
+                const lru_cache::proof_numbers& n = proof_children[i].numbers;
+                if (n.proof < proof) {
+                    second_proof = proof;
+                    proof = n.proof;
+                    best = i;
+                } else if (n.proof < second_proof) {
+                    second_proof = n.proof;
+                }
+                disproof = saturating_add(disproof, n.disproof);
+            }
+
+            if (disproof == 0 || proof >= frame.proof_threshold || disproof >= frame.disproof_threshold) {
+                if (proof_frames.size() == 1) {
+                    assert(disproof == 0);
+                    result_dfpn.sol_type = solver::result::type::UNSOLVABLE;
+                    return result_dfpn;
+                }
+                leave_proof_node(proof, disproof);
+                continue;
+            }
+
+            // Searches the most-proving child until it is no longer better than
+            // the next best, or this node has passed its disproof threshold
+            const move mv = proof_children[best].mv;
+            const proof_frame child_frame{
+                    std::min(frame.proof_threshold, second_proof == infinite_proof ? infinite_proof : second_proof + 1),
+                    frame.disproof_threshold - (disproof - proof_children[best].numbers.disproof),
+                    static_cast<uint32_t>(proof_children.size()),
+                    0
+            };
+            const lru_cache::proof_numbers estimate = proof_children[best].numbers;
+            frame.selected = best;
+
+            state.make_move(mv);
+            frontier.emplace_back(mv, 0);
+            current_node = prev(end(frontier));
+            res.depth++;
+            res.max_depth = max(res.depth, res.max_depth);
+            if (mv.dominance_move) res.dominance_moves++;
+            res.states_searched++;
+
+            pair<lru_cache::handle, bool> insert_res = cache.insert(state);
+            if (insert_res.second) {
+                res.unique_states_searched++;
+                cache.get_proof_numbers(insert_res.first) = estimate;
+            } else {
+                assert(!cache.is_live(insert_res.first));
+                cache.set_live(insert_res.first);
+            }
+            current_node->cache_state = insert_res.first;
+            path_depths[insert_res.first] = static_cast<uint32_t>(proof_frames.size());
+            proof_frames.push_back(child_frame);
+
+            solved = add_proof_children();
+        }
+    } catch (const std::runtime_error &e) {
+        result_dfpn.sol_type = solver::result::type::MEM_LIMIT;
+        return result_dfpn;
+    }
+
+    result_dfpn.sol_type = solver::result::type::SOLVED;
+    return result_dfpn;
+}
+
+// Adds the children of the current node, with their proof numbers as cached,
+// or as estimated if they haven't been searched. A dominance move is the only
+// child if there is one. Returns true if a child is solved, in which case it
+// becomes the current node
+bool solver::add_proof_children() {
+    assert(move_stack.empty());
+
+    optional<move> dominance_move = state.get_dominance_move();
+    if (dominance_move) move_stack.push_back(*dominance_move);
+    else state.get_legal_moves(move_stack, current_node->mv);
+
+    for (move m : move_stack) {
+        state.make_move(m);
+
+        if (state.is_solved()) {
+            move_stack.clear();
+            frontier.emplace_back(m, 0);
+            current_node = prev(end(frontier));
+            res.depth++;
+            res.max_depth = max(res.depth, res.max_depth);
+            if (m.dominance_move) res.dominance_moves++;
+            res.states_searched++;
+            return true;
+        }
+
+        proof_child child{m, {max(state.min_moves_to_solve(), uint32_t(1)), 1}, no_loop};
+        optional<lru_cache::handle> cached = cache.find(state);
+        if (cached && cache.is_live(*cached)) {
+            // Leads back to a state on the search path, so is of no help
+            child.numbers = {infinite_proof, 0};
+            child.loop_depth = path_depths.at(*cached);
+        } else if (cached) {
+            child.numbers = cache.get_proof_numbers(*cached);
+        }
+        proof_children.push_back(child);
+
+        state.undo_move(m);
+    }
+
+    move_stack.clear();
+    return false;
+}
+
+// Goes back up to the parent of the current node, which takes on the node's
+// proof numbers. They are cached, unless the node is disproved only because its
+// children lead back to states on the path above it
+void solver::leave_proof_node(uint64_t proof, uint64_t disproof) {
+    const auto depth = static_cast<uint32_t>(proof_frames.size() - 1);
+    const lru_cache::handle node_state = *current_node->cache_state;
+    const auto first_child = begin(proof_children) + proof_frames.back().first_child;
+
+    uint32_t loop_depth = no_loop;
+    if (disproof == 0) {
+        proof = infinite_proof;
+        for (auto i = first_child; i != end(proof_children); i++) {
+            loop_depth = std::min(loop_depth, i->loop_depth);
+        }
+        // Leading back to the node itself is of no help to it either
+        if (loop_depth >= depth) loop_depth = no_loop;
+    }
+    if (loop_depth == no_loop) {
+        cache.get_proof_numbers(node_state) = lru_cache::proof_numbers{proof, disproof};
+    }
+
+    cache.set_non_live(node_state);
+    path_depths.erase(node_state);
+    proof_children.erase(first_child, end(proof_children));
+    proof_frames.pop_back();
+
+    state.undo_move(current_node->mv);
+    frontier.pop_back();
+    current_node = prev(end(frontier));
+    res.depth--;
+    res.backtracks++;
+
+    proof_child& child = proof_children[proof_frames.back().selected];
+    child.numbers = lru_cache::proof_numbers{proof, disproof};
+    child.loop_depth = loop_depth;
+}
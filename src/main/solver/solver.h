@@ -28,24 +28,42 @@
 #include <vector>
 #include <atomic>
 #include <chrono>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "../game/global_cache.h"
+#include "../game/shared_cache.h"
 #include "../game/sol_rules.h"
 #include "../input-output/input/command_line_helper.h"
 
+class parallel_solver;
+
 class solver {
+    friend class parallel_solver;
 public:
     lru_cache cache;
 
+    // The untried moves of every node in the frontier are kept on one move
+    // stack, with each node holding the range of its own. The current node's
+    // range is always at the top of the stack
     struct node {
-        node(move) noexcept;
+        node(move, uint32_t, uint16_t = 0) noexcept;
+        bool has_children() const;
+
         const move mv;
-        std::vector<move> child_moves;
-        boost::optional<lru_cache::item_list::iterator> cache_state; // Optional, as dominance moves aren't cached
+        uint32_t first_child;
+        uint32_t last_child;
+        boost::optional<lru_cache::handle> cache_state; // Optional, as dominance moves aren't cached
+        uint16_t history_key; // Only set when moves are ordered by history
+        uint8_t discrepancies; // The moves on the path to the node which weren't their node's first
+        bool child_taken;
+        uint32_t sleep_first; // Where the node's sleep set starts on the sleep stack
+        uint32_t chain_first; // Where the dominance moves made after the node's own start on the chain stack
     };
 
     struct result {
-        enum class type { TIMEOUT, SOLVED, UNSOLVABLE, MEM_LIMIT, TERMINATED };
+        enum class type { TIMEOUT, SOLVED, UNSOLVABLE, MEM_LIMIT, TERMINATED, INCONCLUSIVE };
 
         type sol_type;
         uint64_t states_searched;
@@ -53,19 +71,100 @@ public:
         uint64_t backtracks;
         uint64_t dominance_moves;
         uint64_t states_removed_from_cache;
-        lru_cache::item_list::size_type cache_size;
-        lru_cache::item_list::size_type cache_bucket_count;
+        lru_cache::size_type cache_size;
+        lru_cache::size_type cache_bucket_count;
         uint64_t max_depth;
         uint64_t depth;
         std::chrono::milliseconds time;
     };
 
+    // What is kept of a search once it is over: its result, and the moves
+    // from the initial state to where it stopped. Holds no cache, so it can
+    // outlive the solver cheaply
+    class outcome {
+    public:
+        outcome(const game_state&, result, std::vector<move>);
+        outcome(outcome&&) = default;
+        outcome(const outcome&) = delete;
+        outcome& operator=(const outcome&) = delete;
+
+        void print_solution() const;
+
+        const game_state init_state;
+        result res;
+        std::vector<move> moves;
+    };
+
+    // Limits on the moves tried from each state, for a quick search which can
+    // find a solution but can't show there is none. A beam width of 0 and no
+    // discrepancy limit leave the search unlimited
+    struct search_limits {
+        uint32_t beam_width;
+        boost::optional<uint8_t> discrepancies;
+
+        bool limited() const;
+    };
+
     explicit solver(const game_state&, uint64_t);  
+    // Creates one of the threads of a parallel solver
+    solver(const game_state&, parallel_solver&, shared_cache::thread_id);
 
     result run(boost::optional<std::chrono::milliseconds> = boost::none);
+    // Makes the search terminate once the flag is set by another thread
+    void set_cancel_flag(const std::atomic<bool>&);
+    // Orders the moves of each node by how often moves like them (between the
+    // same kinds of pile, with the same card) have led to new states, revealed
+    // cards or been part of a solution so far in the search
+    void enable_history_ordering();
+    // Only tries the first moves of each state: at most the beam width of them,
+    // and only the first once a path has strayed from the first move as many
+    // times as the discrepancy limit allows. States are cached with the
+    // discrepancies left below them, so are searched again if reached with
+    // more left. If no solution is found and moves were left out, the result
+    // is inconclusive
+    void set_search_limits(search_limits);
+    // By default, DFS skips a move if it was tried from an earlier state on
+    // the path and commutes with every move made since, as the search from
+    // there has covered both orders of the moves (sleep sets). Two moves
+    // commute if they move single cards between four different piles, and
+    // only cells and foundations are emptied or filled by them. Threads of a
+    // parallel search and depth-limited searches don't use sleep sets
+    void disable_sleep_sets();
+    // By default, before DFS makes a move, it checks whether the move leads
+    // to a state in the cache which needn't be searched again, and if so moves
+    // on to the next. The hash of the state is worked out from the move, and
+    // only if it is found is the move made, to compare the keys. Not used by
+    // threads of a parallel search, or with a discrepancy limit, as states are
+    // looked up differently then
+    void disable_transposition_lookahead();
+    // Starts the DFS again each time it has searched the next number of states
+    // in the Luby sequence (1, 1, 2, 1, 1, 2, 4, ...) times the base, breaking
+    // ties between moves of the same kind at random. The states searched in
+    // full are kept in the cache and skipped by later runs, so the search is
+    // still complete. The first run with seed 0 keeps the usual move order
+    result run_restarts(uint64_t base_states, uint32_t seed, boost::optional<std::chrono::milliseconds> = boost::none);
+    // Searches with depth-first proof-number search in place of DFS. Proof numbers
+    // start at the heuristic's lower bound on the moves left, and disproof
+    // numbers at 1. Must be run on a new solver
+    result run_DFPN(boost::optional<std::chrono::milliseconds> = boost::none);
+    // Searches with nested rollout policy adaptation in place of DFS. Each level
+    // runs the level below it the given number of times, adapting the policy
+    // towards the best sequence of moves found so far. Level 0 plays random
+    // moves by the policy until the deal is solved, every move leads back to a
+    // state already played through, or the playout reaches its maximum length,
+    // and scores the state it ends in by the heuristic. The result is
+    // inconclusive if every iteration is run without finding a solution. Must
+    // be run on a new solver
+    result run_NRPA(uint32_t level, uint32_t iterations, boost::optional<std::chrono::milliseconds> = boost::none);
+    // Searches with weighted best-first search in place of DFS, expanding the
+    // state with the fewest moves to it plus twice its distance estimate
+    // first. Once the cache is full, goes back to a DFS from the initial
+    // state. Must be run on a new solver
+    result run_best_first(boost::optional<std::chrono::milliseconds> = boost::none);
     result run_DLS(uint64_t depth_limit, boost::optional<std::chrono::milliseconds> = boost::none);
     result run_IDDFS(uint64_t depth_limit, boost::optional<std::chrono::milliseconds> = boost::none);
 
+    outcome get_outcome() const;
     void print_solution() const;
     static void print_header(long, command_line_helper::streamliner_opt);
     static void print_result_csv(solver::result);
@@ -78,19 +177,149 @@ private:
     typedef std::chrono::high_resolution_clock clock;
     typedef std::chrono::milliseconds millisec;
 
-    result dfs(boost::optional<clock::time_point> = boost::none);
-    result dls(uint64_t, boost::optional<clock::time_point> = boost::none); // DFS with depth bound (for finding an optimal solution)
+    result dfs(boost::optional<clock::time_point> = boost::none, boost::optional<uint64_t> state_limit = boost::none);
+    // DFS with depth bound (for finding an optimal solution). States are
+    // cached with the depth left below them, so are only searched again if
+    // reached with more depth left. States whose heuristic lower bound on the
+    // moves left goes past the depth bound aren't expanded
+    result dls(uint64_t, boost::optional<clock::time_point> = boost::none);
+    // Whether an interrupt or the cancel flag has stopped the search
+    bool interrupted() const;
 
-    bool revert_to_last_node_with_children(boost::optional<lru_cache::item_list::iterator> = boost::none);
+    bool revert_to_last_node_with_children(boost::optional<lru_cache::handle> = boost::none);
+    void add_child(move);
+    void add_legal_children();
+    void limit_children();
+    bool commutes(move, move) const;
+    void remove_sleeping_children();
+    bool skip_cached_children();
     void set_to_child();
+    void make_dominance_chain();
+    void undo_dominance_chain();
+    void add_path_moves(std::vector<move>&, std::vector<node>::const_iterator) const;
+    void return_to_root();
+
+    // Move ordering
+    void init_pile_kinds();
+    uint16_t move_kind(move) const;
+    void shuffle_tied_children();
+    uint16_t history_key(move) const;
+    double history_score(move) const;
+    void order_children();
+    void credit_new_state();
+    void credit_solution();
+
+    // Parallel search
+    std::pair<lru_cache::handle, bool> insert_state();
+    void release_state(lru_cache::handle);
+    void donate_work();
+    void start_from(const std::vector<move>&);
 
     game_state state;
     std::vector<node> frontier;
+    std::vector<move> move_stack;
 
     result res;
 
     node root;
     std::vector<node>::iterator current_node;
+
+    // Set when the solver is one of the threads of a parallel solver, in which
+    // case the shared cache is used in place of its own
+    parallel_solver* pool;
+    shared_cache::thread_id thread;
+    const std::atomic<bool>* cancel;
+
+    search_limits limits;
+    bool moves_left_out;
+
+    // The sleep set of each node of the frontier, followed by the moves it has
+    // tried, are kept on one stack, as its untried moves are
+    bool sleep_sets;
+    std::vector<move> sleep_stack;
+
+    // A node reached by a dominance move in DFS stands for the whole chain of
+    // dominance moves from its parent. The moves after the first are kept on
+    // a stack, in the order they were made
+    std::vector<move> chain_stack;
+
+    // Unset if DFS makes each move before looking up the state it leads to
+    bool lookahead;
+
+    // How often each kind of move has been tried and what came of it. Empty
+    // unless history ordering is enabled
+    struct history_entry {
+        uint64_t tries;
+        uint64_t credit;
+    };
+    std::vector<history_entry> history;
+    std::vector<uint8_t> pile_kinds;
+    std::vector<std::pair<double, move>> scored_moves;
+
+    // Breaks ties in the move order at random once a search with restarts has
+    // restarted, or from the start for seeds other than 0
+    boost::optional<std::mt19937> tie_break;
+
+    // Depth-first proof-number search, in solver.dfpn.cpp. Every state is an OR
+    // node, as the player has only to find one way on. The most-proving child
+    // of the current node is searched until its proof or disproof number
+    // reaches the threshold it was given, and the search stops at the first
+    // solved state. A disproof which relies on a state on the search path
+    // leading back to it is only kept by the nodes on the path, and is cached
+    // once the search has gone back up past that state
+    result dfpn(boost::optional<clock::time_point> = boost::none);
+    bool add_proof_children();
+    void leave_proof_node(uint64_t, uint64_t);
+    // Each node of the frontier has a frame, and the children of the frames
+    // are kept one after another, with their proof numbers as last seen. A
+    // child's loop depth is the depth of the shallowest state on the search
+    // path its disproof relies on
+    struct proof_frame {
+        uint64_t proof_threshold;
+        uint64_t disproof_threshold;
+        uint32_t first_child;
+        uint32_t selected;
+    };
+    struct proof_child {
+        move mv;
+        lru_cache::proof_numbers numbers;
+        uint32_t loop_depth;
+    };
+    std::vector<proof_frame> proof_frames;
+    std::vector<proof_child> proof_children;
+    std::unordered_map<lru_cache::handle, uint32_t> path_depths;
+
+    // Nested rollout policy adaptation, in solver.nrpa.cpp. Sequences of moves
+    // are scored by the heuristic's lower bound on the moves left at their end,
+    // and solving the deal stops the search
+    typedef std::unordered_map<uint32_t, double> rollout_policy;
+    typedef std::pair<int64_t, std::vector<move>> scored_sequence;
+    scored_sequence nrpa(uint32_t, uint32_t, rollout_policy, boost::optional<clock::time_point>);
+    scored_sequence playout(const rollout_policy&, boost::optional<clock::time_point>);
+    void adapt_policy(rollout_policy&, const std::vector<move>&);
+    uint32_t rollout_code(move) const;
+    int64_t rollout_score() const;
+    // The states of the current playout are kept so that it doesn't go back to
+    // any of them
+    std::mt19937 rollout_rng;
+    std::unordered_set<uint64_t> playout_states;
+    bool rollout_stopped;
+
+    // Best-first search, in solver.best_first.cpp. Returns none once the cache
+    // is full. Each state found is kept as the move to it from its parent
+    // state, and the open list is a binary heap of states' scores, each packed
+    // with its index. The state is moved between open states along the path
+    // of indices from the first
+    boost::optional<result::type> best_first(boost::optional<clock::time_point>);
+    void go_to_open_state(uint32_t);
+    struct open_state {
+        uint32_t parent;
+        move mv;
+    };
+    std::vector<open_state> open_states;
+    std::vector<uint64_t> open_list;
+    std::vector<uint32_t> open_path;
+    std::vector<uint32_t> target_path;
 };
 
 std::ostream& operator<< (std::ostream&, const solver::result::type&);
@@ -0,0 +1,212 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <signal.h>
+
+#include "solver.h"
+
+using std::vector;
+using std::max;
+using std::begin;
+using std::end;
+using boost::optional;
+
+// Rollouts score a solved deal highest, and stop after this many moves, as
+// some games can go a long way without getting anywhere. Each adaptation moves
+// the policy by the step towards the best sequence
+static const int64_t solved_score = 0;
+static const size_t max_playout_length = 1000;
+static const double rollout_step = 1.0;
+
+solver::result solver::run_NRPA(uint32_t level, uint32_t iterations, optional<millisec> timeout) {
+    assert(frontier.size() == 1);
+
+    // Set interrupt handler
+    signal(SIGINT, sigint_handler);
+
+    // Set timings
+    const clock::time_point start_time = clock::now();
+    const optional<clock::time_point> end_time =
+            boost::make_optional(bool(timeout), start_time + timeout.value_or(millisec(0)));
+
+    scored_sequence best = nrpa(level, iterations, rollout_policy(), end_time);
+
+    // The best sequence found is made the search path, so that its moves are
+    // the outcome's
+    for (move m : best.second) {
+        frontier.emplace_back(m, 0);
+        state.make_move(m);
+    }
+    current_node = prev(end(frontier));
+    res.depth = best.second.size();
+    res.max_depth = max(res.depth, res.max_depth);
+
+    if (best.first == solved_score) {
+        res.sol_type = solver::result::type::SOLVED;
+    } else if (interrupted()) {
+        res.sol_type = solver::result::type::TERMINATED;
+    } else if (rollout_stopped) {
+        res.sol_type = solver::result::type::TIMEOUT;
+    } else {
+        res.sol_type = solver::result::type::INCONCLUSIVE;
+    }
+    res.states_removed_from_cache = cache.get_states_removed_from_cache();
+    res.cache_size = cache.size();
+    res.cache_bucket_count = cache.bucket_count();
+    res.time = std::chrono::duration_cast<millisec>(clock::now() - start_time);
+
+    return res;
+}
+
+// Runs the level below the given number of times, keeping the best sequence
+// found and adapting its own copy of the policy towards it each time
+solver::scored_sequence solver::nrpa(uint32_t level, uint32_t iterations, rollout_policy policy,
+                                     optional<clock::time_point> end_time) {
+    if (level == 0) return playout(policy, end_time);
+
+    scored_sequence best(std::numeric_limits<int64_t>::min(), vector<move>());
+    for (uint32_t i = 0; i < iterations && !rollout_stopped; i++) {
+        scored_sequence seq = nrpa(level - 1, iterations, policy, end_time);
+        if (seq.first >= best.first) best = std::move(seq);
+        if (best.first == solved_score) break;
+
+        adapt_policy(policy, best.second);
+    }
+    return best;
+}
+
+// Plays moves from the initial state, each picked with a probability which
+// grows exponentially with its weight in the policy, until the deal is solved,
+// every move leads back to a state already played through, or the playout is
+// max_playout_length moves long. Dominance moves are always played. The state
+// is left as it was
+solver::scored_sequence solver::playout(const rollout_policy& policy, optional<clock::time_point> end_time) {
+    vector<move> seq;
+    vector<move> moves;
+    vector<double> weights;
+
+    playout_states.clear();
+    playout_states.insert(state.get_hash());
+
+    while (!state.is_solved() && seq.size() < max_playout_length) {
+        if ((end_time && clock::now() >= *end_time) || interrupted()) {
+            rollout_stopped = true;
+            break;
+        }
+        res.states_searched++;
+
+        optional<move> dominance_move = state.get_dominance_move();
+        if (dominance_move) {
+            state.make_move(*dominance_move);
+            playout_states.insert(state.get_hash());
+            seq.push_back(*dominance_move);
+            res.dominance_moves++;
+            continue;
+        }
+
+        moves.clear();
+        state.get_legal_moves(moves, seq.empty() ? move(move::mtype::null) : seq.back());
+
+        // The weights are taken relative to the largest, so they can't overflow
+        weights.clear();
+        for (move m : moves) {
+            auto w = policy.find(rollout_code(m));
+            weights.push_back(w == end(policy) ? 0 : w->second);
+        }
+        const double max_weight = weights.empty() ? 0 : *std::max_element(begin(weights), end(weights));
+        for (double& w : weights) w = std::exp(w - max_weight);
+
+        bool moved = false;
+        while (!moves.empty() && !moved) {
+            std::discrete_distribution<size_t> pick(begin(weights), end(weights));
+            const size_t i = pick(rollout_rng);
+
+            state.make_move(moves[i]);
+            if (playout_states.insert(state.get_hash()).second) {
+                seq.push_back(moves[i]);
+                moved = true;
+            } else {
+                state.undo_move(moves[i]);
+                moves.erase(begin(moves) + i);
+                weights.erase(begin(weights) + i);
+            }
+        }
+        if (!moved) break;
+    }
+
+    const int64_t score = rollout_score();
+    for (auto i = seq.rbegin(); i != seq.rend(); i++) {
+        state.undo_move(*i);
+    }
+    return scored_sequence(score, std::move(seq));
+}
+
+// Raises the weight of each move of the sequence, and lowers those of all the
+// moves which could have been made in its place by how likely each was
+void solver::adapt_policy(rollout_policy& policy, const vector<move>& seq) {
+    const rollout_policy old_policy = policy;
+    auto weight = [&old_policy](uint32_t code) {
+        auto w = old_policy.find(code);
+        return w == end(old_policy) ? 0 : w->second;
+    };
+
+    vector<move> moves;
+    vector<double> weights;
+    for (size_t i = 0; i < seq.size(); i++) {
+        if (!seq[i].dominance_move) {
+            moves.clear();
+            state.get_legal_moves(moves, i == 0 ? move(move::mtype::null) : seq[i - 1]);
+
+            weights.clear();
+            for (move m : moves) weights.push_back(weight(rollout_code(m)));
+            const double max_weight = *std::max_element(begin(weights), end(weights));
+            double total = 0;
+            for (double& w : weights) total += (w = std::exp(w - max_weight));
+
+            for (size_t j = 0; j < moves.size(); j++) {
+                policy[rollout_code(moves[j])] -= rollout_step * weights[j] / total;
+            }
+            policy[rollout_code(seq[i])] += rollout_step;
+        }
+        state.make_move(seq[i]);
+    }
+
+    for (auto i = seq.rbegin(); i != seq.rend(); i++) {
+        state.undo_move(*i);
+    }
+}
+
+// Moves are coded for the policy by their history key and the pile they go to,
+// so that moves of the same card to different piles can be told apart
+uint32_t solver::rollout_code(move m) const {
+    return uint32_t(history_key(m)) << 8 | m.to;
+}
+
+// A sequence is scored by the lower bound on the moves left at its end, with
+// one more for any unsolved state, as the bound can be 0 for them
+int64_t solver::rollout_score() const {
+    if (state.is_solved()) return solved_score;
+    return -int64_t(state.min_moves_to_solve()) - 1;
+}
@@ -0,0 +1,54 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../test_helper.h"
+
+typedef solver::result::type sol_type;
+
+// Also checks whether the cache filled up, so the search went back to a DFS
+static void check_verdicts(uint64_t cache_capacity, bool falls_back) {
+    const std::vector<std::pair<std::string, std::string>> games = {
+            {"resources/free_cell/", "-test-free-cell"},
+            {"resources/klondike/", "-test-klondike"},
+            {"resources/black_hole/", "-test-black-hole"}
+    };
+    for (auto& g : games) {
+        solver solvable(test_helper::load_deal(g.first + "ComplexSolvable.json", g.second), cache_capacity);
+        solver::result res = solvable.run_best_first();
+        ASSERT_TRUE(res.sol_type == sol_type::SOLVED) << g.second;
+        ASSERT_EQ(res.states_removed_from_cache > 0, falls_back) << g.second;
+        ASSERT_TRUE(test_helper::solves(solvable.get_outcome())) << g.second;
+
+        solver unsolvable(test_helper::load_deal(g.first + "ComplexUnsolvable.json", g.second), cache_capacity);
+        ASSERT_TRUE(unsolvable.run_best_first().sol_type == sol_type::UNSOLVABLE) << g.second;
+    }
+}
+
+TEST(BestFirstSearch, Verdicts) {
+    check_verdicts(1000000, false);
+}
+
+// Once the cache is full, the search goes back to a DFS, which reaches the same verdicts
+TEST(BestFirstSearch, FallsBackToDFS) {
+    check_verdicts(30, true);
+}
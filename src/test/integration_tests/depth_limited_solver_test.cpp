@@ -0,0 +1,104 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../../main/solver/parallel_iddfs.h"
+#include "../../main/input-output/input/json-parsing/json_helper.h"
+#include "../../main/input-output/input/json-parsing/rules_parser.h"
+
+using rapidjson::Document;
+
+typedef solver::result::type sol_type;
+
+// A solver run again with a smaller depth limit keeps the cache of its last
+// run, so must reach the same verdict at each depth as a fresh solver
+TEST(DepthLimitedSolver, ReusedCacheMatchesFreshSolver) {
+    const Document in_doc = json_helper::get_file_json("resources/free_cell/SimpleSolvable.json");
+    const sol_rules rules = rules_parser::from_preset("-test-free-cell");
+    const game_state gs(rules, in_doc, game_state::streamliner_options::NONE);
+
+    solver dfs_solver(gs, 1000000);
+    solver::result dfs_res = dfs_solver.run();
+    ASSERT_TRUE(dfs_res.sol_type == sol_type::SOLVED);
+
+    solver reused_solver(gs, 1000000);
+    sol_type fresh_type = sol_type::SOLVED;
+    for (uint64_t depth = dfs_res.depth; fresh_type == sol_type::SOLVED; --depth) {
+        solver fresh_solver(gs, 1000000);
+        fresh_type = fresh_solver.run_DLS(depth).sol_type;
+        ASSERT_TRUE(reused_solver.run_DLS(depth).sol_type == fresh_type) << "depth: " << depth;
+    }
+    ASSERT_TRUE(fresh_type == sol_type::UNSOLVABLE);
+}
+
+// Bisecting the depth bound runs the solver again with a larger limit after
+// finding none within a smaller one
+TEST(DepthLimitedSolver, SolvesAfterUnsolvableDepth) {
+    const Document in_doc = json_helper::get_file_json("resources/free_cell/SimpleSolvable.json");
+    const sol_rules rules = rules_parser::from_preset("-test-free-cell");
+    const game_state gs(rules, in_doc, game_state::streamliner_options::NONE);
+
+    solver dfs_solver(gs, 1000000);
+    solver::result dfs_res = dfs_solver.run();
+    ASSERT_TRUE(dfs_res.sol_type == sol_type::SOLVED);
+
+    solver reused_solver(gs, 1000000);
+    ASSERT_TRUE(reused_solver.run_DLS(1).sol_type == sol_type::UNSOLVABLE);
+    ASSERT_TRUE(reused_solver.run_DLS(dfs_res.depth).sol_type == sol_type::SOLVED);
+}
+
+// Searching several depth limits at once must find a solution as short as
+// lowering the limit one step at a time
+TEST(DepthLimitedSolver, ParallelIterativeDeepening) {
+    const Document in_doc = json_helper::get_file_json("resources/klondike/SimpleSolvable.json");
+    const sol_rules rules = rules_parser::from_preset("-test-klondike");
+    const game_state gs(rules, in_doc, game_state::streamliner_options::NONE);
+
+    solver dfs_solver(gs, 1000000);
+    solver::result dfs_res = dfs_solver.run();
+    ASSERT_TRUE(dfs_res.sol_type == sol_type::SOLVED);
+
+    solver serial_solver(gs, 1000000);
+    uint64_t optimal_depth = dfs_res.depth;
+    while (serial_solver.run_DLS(optimal_depth - 1).sol_type == sol_type::SOLVED) {
+        optimal_depth = serial_solver.get_outcome().moves.size();
+    }
+
+    // Each solution is passed on as soon as it is found
+    std::vector<uint64_t> lengths;
+    parallel_iddfs pi(gs, dfs_res.depth, 1000000, 4);
+    pi.set_solution_callback([&lengths](const solver::outcome& o) { lengths.push_back(o.moves.size()); });
+    pi.run();
+
+    boost::optional<solver::outcome> solution = pi.take_solution();
+    ASSERT_LT(optimal_depth, dfs_res.depth);
+    ASSERT_TRUE(solution);
+    ASSERT_EQ(solution->moves.size(), optimal_depth);
+    ASSERT_TRUE(pi.proved_optimal());
+
+    ASSERT_FALSE(lengths.empty());
+    ASSERT_TRUE(std::is_sorted(lengths.rbegin(), lengths.rend()));
+    ASSERT_TRUE(std::adjacent_find(lengths.begin(), lengths.end()) == lengths.end());
+    ASSERT_EQ(lengths.back(), optimal_depth);
+}
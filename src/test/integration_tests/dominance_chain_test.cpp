@@ -0,0 +1,47 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../test_helper.h"
+
+typedef solver::result::type sol_type;
+typedef game_state::streamliner_options sos;
+
+// The moves of a solution found with chains of dominance moves made as one
+// step include every move of the chains, and the depth counts each of them
+TEST(DominanceChains, SolutionsReplay) {
+    const std::vector<std::pair<std::string, std::string>> games = {
+            {"resources/free_cell/", "-test-free-cell"},
+            {"resources/klondike/", "-test-klondike"}
+    };
+    for (auto& g : games) {
+        for (const char* deal : {"SimpleSolvable", "ComplexSolvable"}) {
+            solver sol(test_helper::load_deal(g.first + deal + ".json", g.second, sos::AUTO_FOUNDATIONS), 1000000);
+            ASSERT_TRUE(sol.run().sol_type == sol_type::SOLVED) << g.second << " " << deal;
+
+            const solver::outcome o = sol.get_outcome();
+            ASSERT_EQ(o.res.depth, o.moves.size()) << g.second << " " << deal;
+            ASSERT_LE(sol.get_frontier().size(), o.moves.size()) << g.second << " " << deal;
+            ASSERT_TRUE(test_helper::solves(o)) << g.second << " " << deal;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../test_helper.h"
+#include "../../main/solver/solver.h"
+#include "../../main/input-output/input/json-parsing/json_helper.h"
+#include "../../main/input-output/input/json-parsing/rules_parser.h"
+
+typedef test_helper th;
+typedef solver::result::type sol_type;
+
+TEST(HistoryOrdering, FreeCell) {
+    EXPECT_TRUE (th::is_solvable("resources/free_cell/ComplexSolvable.json", "-test-free-cell", 1, true));
+    EXPECT_FALSE(th::is_solvable("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell", 1, true));
+}
+
+TEST(HistoryOrdering, Klondike) {
+    EXPECT_TRUE (th::is_solvable("resources/klondike/ComplexSolvable.json", "-test-klondike", 1, true));
+    EXPECT_FALSE(th::is_solvable("resources/klondike/ComplexUnsolvable.json", "-test-klondike", 1, true));
+}
+
+TEST(HistoryOrdering, Gaps) {
+    EXPECT_TRUE (th::is_solvable("resources/gaps/SimpleSolvable.json", "-test-gaps", 1, true));
+    EXPECT_FALSE(th::is_solvable("resources/gaps/SimpleUnsolvable.json", "-test-gaps", 1, true));
+}
+
+TEST(HistoryOrdering, Accordion) {
+    EXPECT_TRUE (th::is_solvable("resources/accordion/ComplexSolvable.json", "-test-accordion", 1, true));
+    EXPECT_FALSE(th::is_solvable("resources/accordion/ComplexUnsolvable.json", "-test-accordion", 1, true));
+}
+
+TEST(HistoryOrdering, ParallelSolver) {
+    EXPECT_TRUE (th::is_solvable("resources/free_cell/ComplexSolvable.json", "-test-free-cell", 4, true));
+    EXPECT_FALSE(th::is_solvable("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell", 4, true));
+}
+
+// The order moves are tried in changes which solution is found first, but not
+// whether there is one within each depth limit
+TEST(HistoryOrdering, KeepsShortestSolution) {
+    const rapidjson::Document in_doc = json_helper::get_file_json("resources/klondike/SimpleSolvable.json");
+    const sol_rules rules = rules_parser::from_preset("-test-klondike");
+    const game_state gs(rules, in_doc, game_state::streamliner_options::NONE);
+
+    solver fixed_solver(gs, 1000000);
+    solver history_solver(gs, 1000000);
+    history_solver.enable_history_ordering();
+
+    sol_type fixed_type = sol_type::SOLVED;
+    for (uint64_t depth = 30; fixed_type == sol_type::SOLVED; --depth) {
+        fixed_type = fixed_solver.run_DLS(depth).sol_type;
+        ASSERT_TRUE(history_solver.run_DLS(depth).sol_type == fixed_type) << "depth: " << depth;
+    }
+    ASSERT_TRUE(fixed_type == sol_type::UNSOLVABLE);
+}
@@ -0,0 +1,51 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../test_helper.h"
+
+typedef solver::result::type sol_type;
+
+static solver::result run_limited(solver& sol, uint32_t beam_width, boost::optional<uint8_t> discrepancies) {
+    sol.set_search_limits(solver::search_limits{beam_width, discrepancies});
+    return sol.run();
+}
+
+// The solutions found by a limited search are still solutions
+TEST(LimitedSearch, FindsSolutions) {
+    solver beam(test_helper::load_deal("resources/black_hole/ComplexSolvable.json", "-test-black-hole"), 1000000);
+    ASSERT_TRUE(run_limited(beam, 2, boost::none).sol_type == sol_type::SOLVED);
+    ASSERT_TRUE(test_helper::solves(beam.get_outcome()));
+
+    solver lds(test_helper::load_deal("resources/klondike/ComplexSolvable.json", "-test-klondike"), 1000000);
+    ASSERT_TRUE(run_limited(lds, 0, uint8_t(4)).sol_type == sol_type::SOLVED);
+    ASSERT_TRUE(test_helper::solves(lds.get_outcome()));
+}
+
+// Running out of states only shows a deal is unsolvable if no moves were left out
+TEST(LimitedSearch, InconclusiveWithoutSolution) {
+    solver greedy(test_helper::load_deal("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell"), 1000000);
+    ASSERT_TRUE(run_limited(greedy, 0, uint8_t(0)).sol_type == sol_type::INCONCLUSIVE);
+
+    solver wide(test_helper::load_deal("resources/klondike/ComplexUnsolvable.json", "-test-klondike"), 1000000);
+    ASSERT_TRUE(run_limited(wide, 1000, boost::none).sol_type == sol_type::UNSOLVABLE);
+}
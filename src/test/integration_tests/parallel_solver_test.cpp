@@ -0,0 +1,46 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <gtest/gtest.h>
+
+#include "../test_helper.h"
+
+typedef test_helper th;
+
+const static uint threads = 4;
+
+TEST(ParallelSolver, FreeCell) {
+    EXPECT_TRUE (th::is_solvable("resources/free_cell/ComplexSolvable.json", "-test-free-cell", threads));
+    EXPECT_FALSE(th::is_solvable("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell", threads));
+}
+
+TEST(ParallelSolver, Klondike) {
+    EXPECT_TRUE (th::is_solvable("resources/klondike/ComplexSolvable.json", "-test-klondike", threads));
+    EXPECT_FALSE(th::is_solvable("resources/klondike/ComplexUnsolvable.json", "-test-klondike", threads));
+}
+
+TEST(ParallelSolver, Spider) {
+    EXPECT_TRUE (th::is_solvable("resources/spider/ComplexSolvable.json", "-test-spider", threads));
+    EXPECT_FALSE(th::is_solvable("resources/spider/SimpleUnsolvable.json", "-test-spider", threads));
+}
+
+TEST(ParallelSolver, Accordion) {
+    EXPECT_TRUE (th::is_solvable("resources/accordion/ComplexSolvable.json", "-test-accordion", threads));
+    EXPECT_FALSE(th::is_solvable("resources/accordion/ComplexUnsolvable.json", "-test-accordion", threads));
+}
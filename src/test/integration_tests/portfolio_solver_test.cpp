@@ -0,0 +1,50 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <gtest/gtest.h>
+
+#include "../../main/solver/portfolio_solver.h"
+#include "../../main/input-output/input/json-parsing/json_helper.h"
+#include "../../main/input-output/input/json-parsing/rules_parser.h"
+
+using rapidjson::Document;
+
+typedef solver::result::type sol_type;
+
+TEST(PortfolioSolver, Solvable) {
+    const Document in_doc = json_helper::get_file_json("resources/klondike/ComplexSolvable.json");
+    portfolio_solver ps(rules_parser::from_preset("-test-klondike"), boost::none, in_doc, 1000000);
+    ps.run();
+
+    const solver::result& stream_res = ps.get_streamliner_result();
+    boost::optional<solver::result> no_stream_res = ps.get_non_streamliner_result();
+    ASSERT_TRUE(stream_res.sol_type == sol_type::SOLVED
+                || (no_stream_res && no_stream_res->sol_type == sol_type::SOLVED));
+}
+
+// Only the search without streamliners can show that a deal is unsolvable
+TEST(PortfolioSolver, Unsolvable) {
+    const Document in_doc = json_helper::get_file_json("resources/free_cell/ComplexUnsolvable.json");
+    portfolio_solver ps(rules_parser::from_preset("-test-free-cell"), boost::none, in_doc, 1000000);
+    ps.run();
+
+    boost::optional<solver::result> no_stream_res = ps.get_non_streamliner_result();
+    ASSERT_TRUE(no_stream_res);
+    ASSERT_TRUE(no_stream_res->sol_type == sol_type::UNSOLVABLE);
+}
@@ -0,0 +1,70 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../../main/input-output/input/json-parsing/json_helper.h"
+#include "../../main/input-output/input/json-parsing/rules_parser.h"
+
+typedef solver::result::type sol_type;
+
+// Solves the deal with proof-number search, checking that any solution found
+// takes the deal to its solved state
+static sol_type solve(const std::string& input_file, const std::string& preset_type) {
+    const rapidjson::Document in_doc = json_helper::get_file_json(input_file);
+    const game_state gs(rules_parser::from_preset(preset_type), in_doc, game_state::streamliner_options::NONE);
+
+    solver sol(gs, 1000000);
+    sol_type res = sol.run_DFPN().sol_type;
+
+    if (res == sol_type::SOLVED) {
+        solver::outcome o = sol.get_outcome();
+        game_state end_state = o.init_state;
+        for (move m : o.moves) end_state.make_move(m);
+        EXPECT_TRUE(end_state.is_solved());
+    }
+    return res;
+}
+
+TEST(ProofNumberSearch, FreeCell) {
+    EXPECT_TRUE(solve("resources/free_cell/ComplexSolvable.json", "-test-free-cell") == sol_type::SOLVED);
+    EXPECT_TRUE(solve("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell") == sol_type::UNSOLVABLE);
+}
+
+TEST(ProofNumberSearch, Klondike) {
+    EXPECT_TRUE(solve("resources/klondike/ComplexSolvable.json", "-test-klondike") == sol_type::SOLVED);
+    EXPECT_TRUE(solve("resources/klondike/ComplexUnsolvable.json", "-test-klondike") == sol_type::UNSOLVABLE);
+}
+
+TEST(ProofNumberSearch, BlackHole) {
+    EXPECT_TRUE(solve("resources/black_hole/ComplexSolvable.json", "-test-black-hole") == sol_type::SOLVED);
+    EXPECT_TRUE(solve("resources/black_hole/ComplexUnsolvable.json", "-test-black-hole") == sol_type::UNSOLVABLE);
+}
+
+TEST(ProofNumberSearch, SpanishPatience) {
+    EXPECT_TRUE(solve("resources/spanish_patience/SimpleSolvable.json", "-test-spanish-patience") == sol_type::SOLVED);
+    EXPECT_TRUE(solve("resources/spanish_patience/SimpleUnsolvable.json", "-test-spanish-patience") == sol_type::UNSOLVABLE);
+}
+
+TEST(ProofNumberSearch, Gaps) {
+    EXPECT_TRUE(solve("resources/gaps/SimpleSolvable.json", "-test-gaps") == sol_type::SOLVED);
+    EXPECT_TRUE(solve("resources/gaps/SimpleUnsolvable.json", "-test-gaps") == sol_type::UNSOLVABLE);
+}
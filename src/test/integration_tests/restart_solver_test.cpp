@@ -0,0 +1,53 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../../main/solver/restart_portfolio.h"
+#include "../test_helper.h"
+
+typedef solver::result::type sol_type;
+
+// A search which restarts every few states still finds a solution, and still
+// exhausts the states of an unsolvable deal
+TEST(RestartSolver, KeepsOutcome) {
+    for (uint32_t seed : {0, 1, 2}) {
+        solver solvable(test_helper::load_deal("resources/free_cell/ComplexSolvable.json", "-test-free-cell"),
+                        1000000);
+        ASSERT_TRUE(solvable.run_restarts(10, seed).sol_type == sol_type::SOLVED) << "seed: " << seed;
+        ASSERT_TRUE(test_helper::solves(solvable.get_outcome()));
+
+        solver unsolvable(test_helper::load_deal("resources/klondike/ComplexUnsolvable.json", "-test-klondike"),
+                          1000000);
+        ASSERT_TRUE(unsolvable.run_restarts(10, seed).sol_type == sol_type::UNSOLVABLE) << "seed: " << seed;
+    }
+}
+
+TEST(RestartSolver, Portfolio) {
+    restart_portfolio solvable(test_helper::load_deal("resources/klondike/ComplexSolvable.json", "-test-klondike"),
+                               1000000, 4, 10);
+    ASSERT_TRUE(solvable.run().sol_type == sol_type::SOLVED);
+    ASSERT_TRUE(test_helper::solves(solvable.get_solver().get_outcome()));
+
+    restart_portfolio unsolvable(
+            test_helper::load_deal("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell"), 1000000, 4, 10);
+    ASSERT_TRUE(unsolvable.run().sol_type == sol_type::UNSOLVABLE);
+}
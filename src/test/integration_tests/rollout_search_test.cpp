@@ -0,0 +1,44 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../test_helper.h"
+
+typedef solver::result::type sol_type;
+
+TEST(RolloutSearch, FindsSolutions) {
+    solver klondike(test_helper::load_deal("resources/klondike/ComplexSolvable.json", "-test-klondike"), 1000000);
+    ASSERT_TRUE(klondike.run_NRPA(2, 100).sol_type == sol_type::SOLVED);
+    ASSERT_TRUE(test_helper::solves(klondike.get_outcome()));
+
+    solver black_hole(test_helper::load_deal("resources/black_hole/ComplexSolvable.json", "-test-black-hole"),
+                      1000000);
+    ASSERT_TRUE(black_hole.run_NRPA(2, 100).sol_type == sol_type::SOLVED);
+    ASSERT_TRUE(test_helper::solves(black_hole.get_outcome()));
+}
+
+// Rollouts can't show a deal is unsolvable, so spending every iteration without
+// a solution is inconclusive
+TEST(RolloutSearch, InconclusiveWithoutSolution) {
+    solver sol(test_helper::load_deal("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell"), 1000000);
+    ASSERT_TRUE(sol.run_NRPA(1, 10).sol_type == sol_type::INCONCLUSIVE);
+}
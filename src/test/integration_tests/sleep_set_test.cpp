@@ -0,0 +1,61 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../test_helper.h"
+
+static const std::vector<std::pair<std::string, std::string>> games = {
+        {"resources/free_cell/", "-test-free-cell"},
+        {"resources/klondike/", "-test-klondike"},
+        {"resources/black_hole/", "-test-black-hole"}
+};
+
+// Skipping commuting moves leaves the verdicts as they were, and never searches
+// more states of a deal searched in full
+TEST(SleepSets, KeepVerdicts) {
+    for (auto& g : games) {
+        for (const char* deal : {"SimpleSolvable", "ComplexSolvable", "SimpleUnsolvable", "ComplexUnsolvable"}) {
+            ASSERT_TRUE(test_helper::keeps_verdict(g.first + deal + ".json", g.second, &solver::disable_sleep_sets))
+                    << g.second << " " << deal;
+        }
+    }
+}
+
+// A state dropped from a cache too small for the deal is searched again with
+// the sleep set of the path it is reached by this time, so the verdicts still
+// hold. Each cache is small enough that states are dropped from it
+TEST(SleepSets, KeepVerdictsWithSmallCache) {
+    const std::vector<std::tuple<std::string, std::string, uint64_t>> deals = {
+            std::make_tuple("resources/klondike/SimpleSolvable.json", "-test-klondike", 11),
+            std::make_tuple("resources/klondike/ComplexSolvable.json", "-test-klondike", 11),
+            std::make_tuple("resources/black_hole/ComplexSolvable.json", "-test-black-hole", 20),
+            std::make_tuple("resources/free_cell/ComplexUnsolvable.json", "-test-free-cell", 12),
+            std::make_tuple("resources/black_hole/ComplexUnsolvable.json", "-test-black-hole", 12)
+    };
+    for (auto& d : deals) {
+        ASSERT_TRUE(test_helper::keeps_verdict(std::get<0>(d), std::get<1>(d), &solver::disable_sleep_sets,
+                                               std::get<2>(d)))
+                << std::get<0>(d) << " with a cache of " << std::get<2>(d);
+    }
+}
@@ -0,0 +1,70 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "../../main/solver/solver.h"
+#include "../test_helper.h"
+
+static const std::vector<std::pair<std::string, std::string>> games = {
+        {"resources/free_cell/", "-test-free-cell"},
+        {"resources/klondike/", "-test-klondike"},
+        {"resources/black_hole/", "-test-black-hole"},
+        {"resources/spider/", "-test-spider"}
+};
+
+// The hash worked out from a move is the one the state has once it is made,
+// checked for each move of the states on random walks through the deals
+TEST(TranspositionLookahead, HashAfterMove) {
+    std::mt19937 rng(0);
+    for (auto& g : games) {
+        for (const char* deal : {"SimpleSolvable", "ComplexSolvable"}) {
+            game_state gs = test_helper::load_deal(g.first + deal + ".json", g.second);
+
+            for (int step = 0; step < 200 && !gs.is_solved(); step++) {
+                const std::vector<move> moves = gs.get_legal_moves();
+                if (moves.empty()) break;
+
+                for (move m : moves) {
+                    boost::optional<uint64_t> h = gs.hash_after(m);
+                    if (!h) continue;
+                    gs.make_move(m);
+                    ASSERT_EQ(*h, gs.get_hash()) << g.second << " " << deal << " step " << step;
+                    gs.undo_move(m);
+                }
+                gs.make_move(moves[rng() % moves.size()]);
+            }
+        }
+    }
+}
+
+// Leaving out the moves to cached states leaves the verdicts as they were, and
+// never searches more states of a deal searched in full
+TEST(TranspositionLookahead, KeepVerdicts) {
+    for (auto& g : games) {
+        for (const char* deal : {"SimpleSolvable", "ComplexSolvable", "SimpleUnsolvable", "ComplexUnsolvable"}) {
+            ASSERT_TRUE(test_helper::keeps_verdict(g.first + deal + ".json", g.second,
+                                                   &solver::disable_transposition_lookahead))
+                    << g.second << " " << deal;
+        }
+    }
+}
@@ -26,6 +26,7 @@
 #include "test_helper.h"
 #include "../main/game/search-state/game_state.h"
 #include "../main/solver/solver.h"
+#include "../main/solver/parallel_solver.h"
 #include "../main/input-output/input/json-parsing/json_helper.h"
 #include "../main/input-output/input/json-parsing/rules_parser.h"
 #include "../../lib/rapidjson/document.h"
@@ -40,16 +41,49 @@ typedef std::initializer_list<std::initializer_list<std::string>> string_il;
 typedef game_state::streamliner_options sos;
 
 
-bool test_helper::is_solvable(const std::string& input_file, const std::string& preset_type) {
+bool test_helper::is_solvable(const std::string& input_file, const std::string& preset_type, uint threads,
+                              bool history_ordering) {
     const Document in_doc = json_helper::get_file_json(input_file);
     const sol_rules rules = rules_parser::from_preset(preset_type);
 
     game_state gs(rules, in_doc, sos::NONE);
+    if (threads > 1) {
+        parallel_solver ps(gs, 1000000, threads);
+        if (history_ordering) ps.enable_history_ordering();
+        return ps.run().sol_type == solver::result::type::SOLVED;
+    }
+
     solver sol(gs, 1000000);
+    if (history_ordering) sol.enable_history_ordering();
 
     return sol.run().sol_type == solver::result::type::SOLVED;
 }
 
+game_state test_helper::load_deal(const std::string& input_file, const std::string& preset_type, sos stream_opts) {
+    const Document in_doc = json_helper::get_file_json(input_file);
+    return game_state(rules_parser::from_preset(preset_type), in_doc, stream_opts);
+}
+
+bool test_helper::solves(const solver::outcome& o) {
+    game_state gs = o.init_state;
+    for (move m : o.moves) gs.make_move(m);
+    return gs.is_solved();
+}
+
+bool test_helper::keeps_verdict(const std::string& input_file, const std::string& preset_type,
+                                void (solver::*disable)(), uint64_t cache_capacity) {
+    const game_state gs = load_deal(input_file, preset_type);
+    solver with(gs, cache_capacity);
+    solver without(gs, cache_capacity);
+    (without.*disable)();
+
+    const solver::result with_res = with.run();
+    const solver::result without_res = without.run();
+    if (with_res.sol_type != without_res.sol_type) return false;
+    return with_res.sol_type != solver::result::type::UNSOLVABLE
+           || with_res.states_searched <= without_res.states_searched;
+}
+
 void test_helper::run_foundations_dominance_test(sol_rules::build_policy policy,
                                                  std::vector<card> cards) {
     sol_rules rules = rules_parser::from_preset("-test-free-cell");
@@ -71,17 +105,21 @@ void test_helper::run_foundations_dominance_test(sol_rules::build_policy policy,
     solver sol(gs, 1000000);
     sol.run();
 
-    auto frontier = sol.get_frontier();
-    auto i = std::begin(frontier);
+    // The whole chain of dominance moves is made as one step of the search
+    ASSERT_EQ(2u, sol.get_frontier().size());
+    ASSERT_FALSE(sol.get_frontier().back().has_children());
+
+    const std::vector<move> moves = sol.get_outcome().moves;
+    ASSERT_EQ(cards.size(), moves.size());
+    auto i = std::begin(moves);
 
     for (card c : cards) {
+        ASSERT_TRUE(i->dominance_move);
+        ASSERT_TRUE(gs.get_data()[i->from].top_card() == c);
+        ASSERT_TRUE(i->to >= 0 && i->to <= 4);
+        gs.make_move(*i);
         i++;
-        ASSERT_TRUE(i->mv.dominance_move);
-        ASSERT_TRUE(gs.get_data()[i->mv.from].top_card() == c);
-        ASSERT_TRUE(i->mv.to >= 0 && i->mv.to <= 4);
-        gs.make_move(i->mv);
     }
-    ASSERT_TRUE(i->child_moves.empty());
 }
 
 void test_helper::expected_moves_test(sol_rules sr,
@@ -31,10 +31,19 @@
 #include "../main/game/pile.h"
 #include "../main/game/move.h"
 #include "../main/game/search-state/game_state.h"
+#include "../main/solver/solver.h"
 
 class test_helper {
 public:
-    static bool is_solvable(const std::string&, const std::string&);
+    static bool is_solvable(const std::string&, const std::string&, uint threads = 1, bool history_ordering = false);
+    static game_state load_deal(const std::string&, const std::string&,
+                                game_state::streamliner_options = game_state::streamliner_options::NONE);
+    // Runs the outcome's moves from the initial state
+    static bool solves(const solver::outcome&);
+    // Whether a DFS with a pruning disabled reaches the same verdict as one
+    // with it, and searches no fewer states of an unsolvable deal
+    static bool keeps_verdict(const std::string&, const std::string&, void (solver::*disable)(),
+                              uint64_t cache_capacity = 1000000);
     static void run_foundations_dominance_test(sol_rules::build_policy policy,
                                                std::vector<card> cards);
     static void expected_moves_test(sol_rules sr, std::initializer_list<std::initializer_list<std::string>>,
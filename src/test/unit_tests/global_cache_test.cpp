@@ -95,3 +95,132 @@ TEST(GlobalCache, CommutativeCells) {
     ASSERT_TRUE (cache.contains(game_state(rules, {{},{"4C"},{"5D"}})));
     ASSERT_FALSE(cache.contains(game_state(rules, {{},{"4C"},{}})));
 }
+
+TEST(GlobalCache, TwoDeckStates) {
+    sol_rules rules;
+    rules.tableau_pile_count = 2;
+    rules.two_decks = true;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, string_il{{},{}});
+    lru_cache cache(gs, 1000);
+
+    // The keys for these states span several words, so differences at the
+    // end of the state must still be seen
+    cache.insert(game_state(rules, {
+            {"AC","AC","2C","2C","3C","3C","4C","4C","5C","5C","6C","6C","7C","7C"},
+            {"AD","AD","2D","2D","3D","3D","4D","4D","5D","5D","6D","6D","7D","7D"}
+    }));
+    ASSERT_TRUE (cache.contains(game_state(rules, {
+            {"AD","AD","2D","2D","3D","3D","4D","4D","5D","5D","6D","6D","7D","7D"},
+            {"AC","AC","2C","2C","3C","3C","4C","4C","5C","5C","6C","6C","7C","7C"}
+    })));
+    ASSERT_FALSE(cache.contains(game_state(rules, {
+            {"AC","AC","2C","2C","3C","3C","4C","4C","5C","5C","6C","6C","7C","7C"},
+            {"AD","AD","2D","2D","3D","3D","4D","4D","5D","5D","6D","6D","7D","7H"}
+    })));
+    ASSERT_FALSE(cache.contains(game_state(rules, {
+            {"AC","AC","2C","2C","3C","3C","4C","4C","5C","5C","6C","6C","7C","7C"},
+            {"AD","AD","2D","2D","3D","3D","4D","4D","5D","5D","6D","6D","7D"}
+    })));
+}
+
+TEST(GlobalCache, EvictsNonLiveStates) {
+    sol_rules rules;
+    rules.tableau_pile_count = 2;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, string_il{{},{}});
+    lru_cache cache(gs, 2);
+
+    auto first = cache.insert(game_state(rules, {{"AC"},{"2C"}}));
+    ASSERT_TRUE(first.second);
+    cache.insert(game_state(rules, {{"AC"},{"3C"}}));
+
+    // Both states are live, so neither can make room for a third
+    ASSERT_THROW(cache.insert(game_state(rules, {{"AC"},{"4C"}})), std::runtime_error);
+
+    cache.set_non_live(first.first);
+    ASSERT_TRUE (cache.insert(game_state(rules, {{"AC"},{"4C"}})).second);
+    ASSERT_EQ   (cache.size(), 2);
+    ASSERT_EQ   (cache.get_states_removed_from_cache(), 1);
+    ASSERT_FALSE(cache.contains(game_state(rules, {{"AC"},{"2C"}})));
+    ASSERT_TRUE (cache.contains(game_state(rules, {{"AC"},{"3C"}})));
+    ASSERT_TRUE (cache.contains(game_state(rules, {{"AC"},{"4C"}})));
+
+    cache.clear();
+    ASSERT_EQ   (cache.size(), 0);
+    ASSERT_EQ   (cache.get_states_removed_from_cache(), 0);
+}
+
+TEST(GlobalCache, SearchesAgainWithMoreDepth) {
+    sol_rules rules;
+    rules.tableau_pile_count = 2;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, {{"AC"},{"2C"}});
+    lru_cache cache(gs, 1000);
+
+    auto first = cache.insert(gs, 5);
+    ASSERT_TRUE (first.second);
+    // Live states are never searched again
+    ASSERT_FALSE(cache.insert(gs, 8).second);
+
+    cache.set_non_live(first.first);
+    ASSERT_FALSE(cache.insert(gs, 5).second);
+    ASSERT_FALSE(cache.insert(gs, 3).second);
+    ASSERT_TRUE (cache.insert(gs, 6).second);
+
+    // A state whose search was cut short is searched again at any depth
+    cache.set_unsearched(first.first);
+    ASSERT_TRUE (cache.insert(gs, 1).second);
+}
+
+TEST(GlobalCache, ProofNumbers) {
+    sol_rules rules;
+    rules.tableau_pile_count = 2;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, {{"AC"},{"2C"}});
+    lru_cache cache(gs, 1000);
+    cache.enable_proof_numbers();
+
+    // Finding a state doesn't insert it
+    ASSERT_FALSE(cache.find(gs));
+    auto entry = cache.insert(gs).first;
+    ASSERT_TRUE (cache.find(gs) && *cache.find(gs) == entry);
+
+    ASSERT_TRUE (cache.is_live(entry));
+    ASSERT_EQ   (cache.get_proof_numbers(entry).proof, 0u);
+    cache.get_proof_numbers(entry) = lru_cache::proof_numbers{3, 1};
+    cache.set_non_live(entry);
+    ASSERT_FALSE(cache.is_live(entry));
+
+    cache.set_live(entry);
+    ASSERT_TRUE (cache.is_live(entry));
+    ASSERT_EQ   (cache.get_proof_numbers(entry).proof, 3u);
+    ASSERT_EQ   (cache.get_proof_numbers(entry).disproof, 1u);
+}
+
+TEST(GlobalCache, WasteDealSymmetry) {
+    sol_rules rules;
+    rules.stock_size = 3;
+    rules.stock_deal_t = sol_rules::stock_deal_type::WASTE;
+    rules.stock_redeal = true;
+    rules.tableau_pile_count = 1;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, string_il{{},{},{}});
+    lru_cache cache(gs, 1000);
+
+    // With a redeal, dealing from the stock to the waste reaches a state
+    // already seen on a previous pass
+    cache.insert               (game_state(rules, {{"AC","2C"},{"3C"},{"4C"}}));
+    ASSERT_TRUE (cache.contains(game_state(rules, {{"AC","2C","3C"},{},{"4C"}})));
+    ASSERT_TRUE (cache.contains(game_state(rules, {{"AC"},{"3C","2C"},{"4C"}})));
+    ASSERT_FALSE(cache.contains(game_state(rules, {{"AC"},{"2C","3C"},{"4C"}})));
+
+    // Without it, the split between the stock and waste matters
+    rules.stock_redeal = false;
+    game_state gs_no_redeal(rules, string_il{{},{},{}});
+    lru_cache cache_no_redeal(gs_no_redeal, 1000);
+
+    cache_no_redeal.insert               (game_state(rules, {{"AC","2C"},{"3C"},{"4C"}}));
+    ASSERT_TRUE (cache_no_redeal.contains(game_state(rules, {{"AC","2C"},{"3C"},{"4C"}})));
+    ASSERT_FALSE(cache_no_redeal.contains(game_state(rules, {{"AC","2C","3C"},{},{"4C"}})));
+}
@@ -0,0 +1,80 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <gtest/gtest.h>
+
+#include "../../main/game/search-state/game_state.h"
+#include "../../main/input-output/input/json-parsing/rules_parser.h"
+
+typedef sol_rules::built_group_type bgt;
+
+TEST(Heuristics, CardsNotOnFoundations) {
+    sol_rules rules = rules_parser::from_preset("-test-free-cell");
+    rules.cells = 0;
+    rules.move_built_group = bgt::NO;
+
+    game_state gs(rules, {
+            {"AC"},
+            {},
+            {},
+            {},
+            {"2C","3C","4C"},          // 3C and 4C are above the 2C
+            {"AH","2H","4S"},          // 2H is above the AH
+            {"4H","3H","AS"},
+            {"2S","3S","4D","3D","2D","AD"} // 3S is above the 2S
+    });
+
+    // Each of the 15 cards needs a move to the foundations, and each of the 4
+    // cards above a lower card of its suit needs a move off its pile first
+    ASSERT_EQ(gs.min_moves_to_solve(), 19);
+
+    // Built groups can take several cards off a pile in one move
+    rules.move_built_group = bgt::YES;
+    game_state gs_built_groups(rules, {
+            {"AC"},
+            {},
+            {},
+            {},
+            {"2C","3C","4C"},
+            {"AH","2H","4S"},
+            {"4H","3H","AS"},
+            {"2S","3S","4D","3D","2D","AD"}
+    });
+    ASSERT_EQ(gs_built_groups.min_moves_to_solve(), 15);
+}
+
+TEST(Heuristics, SolvedState) {
+    sol_rules rules = rules_parser::from_preset("-test-free-cell");
+    rules.cells = 0;
+
+    game_state gs(rules, {
+            {"AC","2C","3C","4C"},
+            {"AH","2H","3H","4H"},
+            {"AS","2S","3S","4S"},
+            {"AD","2D","3D","4D"},
+            {},
+            {},
+            {},
+            {}
+    });
+
+    ASSERT_TRUE(gs.is_solved());
+    ASSERT_EQ(gs.min_moves_to_solve(), 0);
+}
@@ -25,6 +25,7 @@
 
 #include "../test_helper.h"
 #include "../../main/game/pile.h"
+#include "../../main/game/pile_ref_list.h"
 
 TEST(Pile, Size) {
     pile p = {};
@@ -104,3 +105,21 @@ TEST(Pile, CompOperators) {
     ASSERT_LT(p1, p4);
     ASSERT_EQ(p4, p4);
 }
+
+TEST(PileRefList, InsertAndRemove) {
+    pile_ref_list l;
+    ASSERT_TRUE(l.empty());
+
+    l.push_back(1);
+    l.push_back(3);
+    l.insert(l.begin() + 1, 2);
+    l.insert(l.begin(), 0);
+    ASSERT_EQ(4, l.size());
+    for (pile::ref i = 0; i < 4; i++) ASSERT_EQ(i, l[i]);
+
+    l.remove(2);
+    l.erase(l.begin());
+    ASSERT_EQ(2, l.size());
+    ASSERT_EQ(1, l.front());
+    ASSERT_EQ(3, l[1]);
+}
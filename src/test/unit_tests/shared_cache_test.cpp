@@ -0,0 +1,99 @@
+/*
+  Solvitaire: a solver for perfect information solitaire games
+  Copyright (C) 2018 Charles Blake <thecharlesblake@live.co.uk> and 
+  Ian Gent <Ian.Gent@st-andrews.ac.uk>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program (see LICENSE file); if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <thread>
+#include <atomic>
+#include <gtest/gtest.h>
+
+#include "../test_helper.h"
+#include "../../main/game/search-state/game_state.h"
+#include "../../main/game/shared_cache.h"
+
+typedef std::initializer_list<std::initializer_list<std::string>> string_il;
+
+TEST(SharedCache, ClaimsStates) {
+    sol_rules rules;
+    rules.tableau_pile_count = 3;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, string_il{{},{},{}});
+    shared_cache cache(gs, 1000);
+
+    auto claim = cache.insert(game_state(rules, {{"AC"},{"2D"},{"3H"}}), 0);
+    ASSERT_TRUE (claim.second);
+    ASSERT_TRUE (cache.get_status(claim.first) == shared_cache::status::IN_PROGRESS);
+    ASSERT_EQ   (cache.get_owner(claim.first), 0);
+
+    // The same state (up to pile order) can't be claimed by another thread
+    auto second_claim = cache.insert(game_state(rules, {{"2D"},{"3H"},{"AC"}}), 1);
+    ASSERT_FALSE(second_claim.second);
+    ASSERT_EQ   (second_claim.first, claim.first);
+
+    cache.set_explored(claim.first);
+    ASSERT_TRUE (cache.get_status(claim.first) == shared_cache::status::EXPLORED);
+    ASSERT_TRUE (cache.contains(game_state(rules, {{"3H"},{"AC"},{"2D"}})));
+    ASSERT_FALSE(cache.contains(game_state(rules, {{"3H"},{"AC"},{}})));
+    ASSERT_EQ   (cache.size(), 1);
+}
+
+TEST(SharedCache, FullCacheThrows) {
+    sol_rules rules;
+    rules.tableau_pile_count = 1;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, string_il{{}});
+    shared_cache cache(gs, 1);
+
+    cache.insert(game_state(rules, {{"AC"}}), 0);
+    ASSERT_THROW(cache.insert(game_state(rules, {{"2C"}}), 0), std::runtime_error);
+}
+
+TEST(SharedCache, ConcurrentClaims) {
+    sol_rules rules;
+    rules.tableau_pile_count = 2;
+    rules.build_pol = sol_rules::build_policy::SAME_SUIT;
+    game_state gs(rules, string_il{{},{}});
+    shared_cache cache(gs, 10000);
+
+    std::vector<std::string> cards;
+    for (std::string suit : {"C", "D", "H", "S"}) {
+        for (std::string rank : {"A","2","3","4","5","6","7","8","9","10","J","Q","K"}) {
+            cards.push_back(rank + suit);
+        }
+    }
+
+    // Every thread tries to claim every state. Each state must be claimed
+    // exactly once
+    std::atomic<int> claims(0);
+    std::vector<std::thread> threads;
+    for (shared_cache::thread_id t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (auto& a : cards) {
+                for (auto& b : cards) {
+                    if (cache.insert(game_state(rules, {{a},{b}}), t).second) claims++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // Pile order symmetry makes {a},{b} and {b},{a} the same state
+    int distinct = int(cards.size() * (cards.size() + 1) / 2);
+    ASSERT_EQ(claims.load(), distinct);
+    ASSERT_TRUE(cache.contains(game_state(rules, {{"KS"},{"AC"}})));
+}